@@ -91,8 +91,74 @@
 #include<array>
 #include<thread>
 #include<chrono>
+#include<tuple>
+#include<type_traits>
+#include<string_view>
+#include<unordered_map>
+#include<cstdint>
+#include<cstring>
+#include<iterator>
+#include<memory>
+#include<concepts>
+#include<initializer_list>
+#include<utility>
+#include<bit>
+#include<fstream>
+#include<cstdio>
+#include<filesystem>
+#include<atomic>
+#include<random>
+#include<mutex>
+#include<shared_mutex>
+#include<condition_variable>
+#include<limits>
+#include<optional>
+#include<sstream>
+#include<map>
+#include<iomanip>
+#include<cctype>
+#include<stdexcept>
+#include<exception>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 int global{ 99 };													//non-local variable
+
+// Timing helper used by the benchmark routines further down
+// runs the callable once and returns how long it took in milliseconds
+template<typename Func>
+double elapsed_ms(Func&& func)
+{
+	auto start = std::chrono::steady_clock::now();
+	func();
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
 void findstring()
 {
 	//1. 
@@ -125,9 +191,228 @@ void findstring()
 	std::cout << std::endl;
 }
 
+// 
+// SEARCHING FOR SUBSTRINGS
+// 
+// std::find() looks for one element, std::search() and string::find() look for one sequence
+// Often we want every match of a word, or of a whole set of words, in a big buffer
+// 
+// find_all() - one pattern
+//		- first compare the FIRST and LAST byte of the pattern against 16 positions at once (SSE2),
+//		  only positions where both match are checked with memcmp()
+//		- without SSE2, memchr() finds candidates for the first byte
+// 
+// aho_corasick - a set of patterns, one pass over the text
+//		- the patterns are built into a trie, and each state gets a transition for every byte,
+//		  so the text is scanned with one table lookup per character no matter how many patterns there are
+//		- every match (including overlapping ones and patterns inside other patterns) is reported
+// 
+// Both report matches through a callback as they are found, so nothing is collected unless you want it
+//		on_match(position)					for find_all()
+//		on_match(position, pattern_index)	for aho_corasick::search()
+//
+
+template<typename OnMatch>
+void find_all(std::string_view text, std::string_view pattern, OnMatch on_match)
+{
+	const std::size_t m = pattern.size();
+	if (m == 0 || m > text.size())
+		return;
+
+	const char* base = text.data();
+	const std::size_t last_start = text.size() - m;					// the last position a match can start at
+	std::size_t i{ 0 };
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	const __m128i first = _mm_set1_epi8(pattern.front());
+	const __m128i last = _mm_set1_epi8(pattern.back());
+	for (; i + 16 <= last_start + 1; i += 16) {
+		__m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i));
+		__m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i + m - 1));
+		auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+		while (mask) {
+			std::size_t pos = i + std::countr_zero(mask);
+			if (std::memcmp(base + pos + 1, pattern.data() + 1, m - 1) == 0)
+				on_match(pos);
+			mask &= mask - 1;
+		}
+	}
+#endif
+	while (i <= last_start) {
+		auto p = static_cast<const char*>(std::memchr(base + i, pattern.front(), last_start + 1 - i));
+		if (!p)
+			break;
+		std::size_t pos = p - base;
+		if (std::memcmp(p + 1, pattern.data() + 1, m - 1) == 0)
+			on_match(pos);
+		i = pos + 1;
+	}
+}
+
+class aho_corasick {
+private:
+	static constexpr std::int32_t none{ -1 };
+
+	std::vector<std::array<std::int32_t, 256>> next;				// transitions while building
+	std::vector<std::uint32_t> table;								// the finished automaton: table[row + byte] is the next row, row = state * 256
+	std::vector<std::uint8_t> reports;								// does this state end at least one pattern
+	std::vector<std::int32_t> fail;
+	std::vector<std::int32_t> match;								// pattern which ends in this state, or none
+	std::vector<std::int32_t> dict_link;							// nearest state on the fail chain with a match
+	std::vector<std::size_t> lengths;
+
+	std::int32_t add_state() {
+		next.emplace_back();
+		next.back().fill(none);
+		fail.push_back(0);
+		match.push_back(none);
+		dict_link.push_back(none);
+		return static_cast<std::int32_t>(next.size() - 1);
+	}
+
+public:
+	explicit aho_corasick(const std::vector<std::string>& patterns) {
+		add_state();													// the root
+
+		for (std::size_t p = 0; p < patterns.size(); ++p) {
+			std::int32_t s{ 0 };
+			for (unsigned char c : patterns[p]) {
+				if (next[s][c] == none) {
+					std::int32_t t = add_state();						// may reallocate next, so no reference is held across it
+					next[s][c] = t;
+				}
+				s = next[s][c];
+			}
+			if (match[s] == none)									// duplicate patterns report the first one
+				match[s] = static_cast<std::int32_t>(p);
+			lengths.push_back(patterns[p].size());
+		}
+
+		// breadth first: fill in fail links and turn the trie into a complete automaton
+		std::deque<std::int32_t> queue;
+		for (int c = 0; c < 256; ++c) {
+			if (next[0][c] == none)
+				next[0][c] = 0;
+			else
+				queue.push_back(next[0][c]);
+		}
+		while (!queue.empty()) {
+			std::int32_t s = queue.front();
+			queue.pop_front();
+			dict_link[s] = match[fail[s]] != none ? fail[s] : dict_link[fail[s]];
+			for (int c = 0; c < 256; ++c) {
+				std::int32_t t = next[s][c];
+				if (t == none) {
+					next[s][c] = next[fail[s]][c];
+				}
+				else {
+					fail[t] = next[fail[s]][c];
+					queue.push_back(t);
+				}
+			}
+		}
+
+		// flatten into one table of row offsets, so the scan loop is a single dependent load per byte
+		table.resize(next.size() * 256);
+		reports.resize(next.size());
+		for (std::size_t st = 0; st < next.size(); ++st) {
+			for (int c = 0; c < 256; ++c)
+				table[st * 256 + c] = static_cast<std::uint32_t>(next[st][c]) * 256;
+			reports[st] = (match[st] != none || dict_link[st] != none);
+		}
+		next.clear();
+		next.shrink_to_fit();
+	}
+
+	std::size_t states() const { return reports.size(); }
+
+	// on_match(start_position, pattern_index) for every occurrence of every pattern
+	template<typename OnMatch>
+	void search(std::string_view text, OnMatch on_match) const {
+		std::uint32_t row{ 0 };
+		for (std::size_t i = 0; i < text.size(); ++i) {
+			row = table[row + static_cast<unsigned char>(text[i])];
+			if (!reports[row / 256])
+				continue;
+			std::int32_t s = static_cast<std::int32_t>(row / 256);
+			for (std::int32_t t = match[s] != none ? s : dict_link[s]; t != none; t = dict_link[t])
+				on_match(i + 1 - lengths[match[t]], static_cast<std::size_t>(match[t]));
+		}
+	}
+};
+
+void find_substrings_Example()
+{
+	std::string str{ "Hello World, hello again World" };
+	std::cout << "\nString: " << str << "\n";
+
+	std::cout << "find_all(\"World\") matches at: ";
+	find_all(str, "World", [](std::size_t pos) { std::cout << pos << ", "; });
+	std::cout << "\n";
+
+	std::vector<std::string> patterns{ "ello", "World", "lo", "again" };
+	aho_corasick ac(patterns);
+	std::cout << "aho_corasick with { \"ello\", \"World\", \"lo\", \"again\" }:\n";
+	ac.search(str, [&patterns](std::size_t pos, std::size_t p) {
+		std::cout << "  \"" << patterns[p] << "\" at index " << pos << "\n";
+	});
+}
+
+void substring_search_benchmark(std::size_t text_bytes = 256 * 1024 * 1024)
+{
+	// random lower case words, with a few known needles dropped in
+	std::mt19937 rng(1);
+	std::string text(text_bytes, ' ');
+	for (auto& c : text)
+		if (rng() % 7 != 0)
+			c = static_cast<char>('a' + rng() % 26);
+	const std::vector<std::string> needles{ "benjamin", "vassili", "finguy", "william", "priscilla", "rebecca", "nataliana", "michael" };
+	std::size_t planted{ 0 };
+	for (std::size_t pos = 4096; pos + 16 < text.size(); pos += 65536, ++planted)
+		text.replace(pos, needles[planted % needles.size()].size(), needles[planted % needles.size()]);
+
+	const double gb = static_cast<double>(text.size()) / (1024.0 * 1024.0 * 1024.0);
+	std::cout << "\nsearching " << text.size() / (1024 * 1024) << " MB of text\n";
+
+	// one pattern
+	const std::string& needle = needles[1];
+	std::size_t c1{ 0 }, c2{ 0 }, c3{ 0 };
+	double t_find = elapsed_ms([&] {
+		for (auto pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+			++c1;
+	});
+	double t_search = elapsed_ms([&] {
+		for (auto it = std::search(std::cbegin(text), std::cend(text), std::cbegin(needle), std::cend(needle));
+			it != std::cend(text); it = std::search(it + 1, std::cend(text), std::cbegin(needle), std::cend(needle)))
+			++c2;
+	});
+	double t_all = elapsed_ms([&] { find_all(text, needle, [&c3](std::size_t) { ++c3; }); });
+
+	std::cout << "one pattern \"" << needle << "\":\n"
+		<< "  std::string::find : " << gb / t_find * 1000.0 << " GB/s (" << c1 << " matches)\n"
+		<< "  std::search       : " << gb / t_search * 1000.0 << " GB/s (" << c2 << " matches)\n"
+		<< "  find_all          : " << gb / t_all * 1000.0 << " GB/s (" << c3 << " matches)\n";
+
+	// the whole set
+	std::size_t m1{ 0 }, m2{ 0 };
+	double t_each = elapsed_ms([&] {
+		for (const auto& n : needles)
+			for (auto pos = text.find(n); pos != std::string::npos; pos = text.find(n, pos + 1))
+				++m1;
+	});
+	aho_corasick ac(needles);
+	double t_ac = elapsed_ms([&] { ac.search(text, [&m2](std::size_t, std::size_t) { ++m2; }); });
+
+	std::cout << needles.size() << " patterns:\n"
+		<< "  std::string::find per pattern : " << gb / t_each * 1000.0 << " GB/s (" << m1 << " matches)\n"
+		<< "  aho_corasick                  : " << gb / t_ac * 1000.0 << " GB/s (" << m2 << " matches, " << ac.states() << " states)\n";
+}
+
 
 //for sorting() function, Define a predicate function 
-bool is_shorter(const std::string& lhs, const std::string& rhs)
+//std::string_view arguments let the same predicate sort std::string and views into a mapped file (see name_corpus)
+bool is_shorter(std::string_view lhs, std::string_view rhs)
 {
 	return lhs.size() < rhs.size();		//predicate function has to return a bool
 }
@@ -142,7 +427,7 @@ public:
 	// takes two strings as arguments
 	// returns true/false depending on relative stirng length
 	
-	bool operator() (const std::string& lhs, const std::string& rhs)
+	constexpr bool operator() (std::string_view lhs, std::string_view rhs)
 	{
 		return lhs.size() < rhs.size();
 	}
@@ -156,7 +441,7 @@ void sorting()
 
 	std::cout << "Vector before sort(): ";
 
-	for (auto name : names)
+	for (const auto& name : names)
 		std::cout << name << ", ";
 	std::cout << std::endl << std::endl;
 
@@ -166,7 +451,7 @@ void sorting()
 
 	std::cout << "\nVector AFTER sort(): ";
 
-	for (auto name : names)
+	for (const auto& name : names)
 		std::cout << name << ", ";
 	std::cout << std::endl;
 	std::cout << "The vector has been sorted alphabetically";
@@ -177,7 +462,7 @@ void sorting()
 	
 	std::sort(std::begin(names), std::end(names), is_shorter);
 	std::cout << "\nsorted by length: ";
-	for (auto name : names)
+	for (const auto& name : names)
 		std::cout << name << ", ";
 	std::cout << std::endl << std::endl;
 
@@ -192,7 +477,7 @@ void sorting_with_object()
 
 	std::cout << "Vector before sort(): ";
 
-	for (auto name : names)
+	for (const auto& name : names)
 		std::cout << name << ", ";
 	std::cout << std::endl << std::endl;
 
@@ -203,202 +488,1450 @@ void sorting_with_object()
 
 	
 	std::cout << "sorted by length: ";
-	for (auto name : names)
+	for (const auto& name : names)
 		std::cout << name << ", ";
 	std::cout << std::endl << std::endl;
 	std::cout << "Functor syntax can be slightly easier than a function pointer." << std::endl;
 
 }
 
-// Algorithms with predicates:
-//	Many algorithms call a function on each element which returns bool
-//		- find() calls  the == operator for each element to compare it to the target value
-// 
-// this is known as a "Predicate"
-// 
-// These algorithms allow us to supply our own predicate
-// 
-// We can pass a callable object as an optional extra argument to the algorithm call
 // 
+// TOP-K: only the k shortest (or longest) names
 // 
-// std::sort();
-// 
-// the sort algorithm works by comparing pairs of elements
-// the comparison is called by calling the elements < operator on each pair of elements
-// 
-// sort() moves the smallest elements to the front and the largest to the rear of
-// the container (by a clever choice of which pairs to compare, the sort can be very efficient.
-// 
+// Sorting the whole vector just to look at the first few elements does a lot of work we never use,
+// O(n log n) when we only need k elements
 // 
+// smallest_k() returns the k elements which would come first after std::sort(..., comp), in that order
+// largest_k() returns the k which would come last, the biggest first
+//		- small k: keep a heap of the best k seen so far. Most elements are rejected with a single
+//		  comparison against the top of the heap: about n comparisons plus k log k
+//		- larger k: copy the range, std::nth_element() (introselect, O(n) on average) to move the
+//		  k smallest to the front, then sort just those k
+//		- parallel_smallest_k(): every thread finds the best k of its own slice with a heap,
+//		  then the k * threads candidates are reduced to the final k
 // 
+// Any std::sort() comparator works, e.g. is_shorter, is_shorter_2() or std::greater<std::string>()
 //
-// --------------------------------------------------------------------------------------------
-// 
-// Algorithms with _if versions:
-//		Many Algorithms have two versions
-//			- the base version which takes a value argument
-//			- An _if version which takes a predicate argument
-// 
-//		find() takes a value and searches for the first element with it's value
-//		find_if() takes a predicate function and searches for the first element 
-//	for which this predicate returns true
-// 
-//		we can use a functor to provide this predicate
-// 
-// 
-
-// Functor for _if predicate explicit
-class greater_than_5 {
-public:
-	bool operator () (const std::string& s) const {
-		return (s.size() > 5);
-	}
-};
 
-// Functor for _if predicate of any number
-//suppose we want to look for any number of characters
-// we do that by adding a state to our functor
+inline constexpr std::size_t top_k_heap_limit{ 1024 };
 
-class ge_n {
+// swaps the arguments of a comparator, so "smallest" becomes "largest"
+template<typename Compare>
+class flipped {
 private:
-	const int n;
+	mutable Compare comp;										// mutable: is_shorter_2::operator() is not const
 public:
-	ge_n(const int n) : n(n) {}
-
-	bool operator () (const std::string& str) const {
-		return str.size() > n;
-	}
+	explicit flipped(Compare comp) : comp(comp) {}
+	template<typename A, typename B>
+	bool operator() (const A& lhs, const B& rhs) const { return comp(rhs, lhs); }
 };
 
-
-
-void _if_Finder()
+template<typename ForwardIt, typename Compare>
+std::vector<std::iter_value_t<ForwardIt>> smallest_k_heap(ForwardIt first, ForwardIt last, std::size_t k, Compare comp)
 {
-	//manually coded example
-	std::vector<std::string> names = { "AJ","Jeny", "Dax", "Wally", "Allice", "Michael", "Kim","Jo", "Nataliana","Rebecca-Jane"};
+	std::vector<std::iter_value_t<ForwardIt>> best;
+	if (k == 0)
+		return best;
+	best.reserve(k);
+
+	for (; first != last && best.size() < k; ++first)
+		best.push_back(*first);
+	std::make_heap(std::begin(best), std::end(best), comp);		// the top is the WORST of the k kept so far
+
+	for (; first != last; ++first) {
+		if (comp(*first, best.front())) {
+			std::pop_heap(std::begin(best), std::end(best), comp);
+			best.back() = *first;
+			std::push_heap(std::begin(best), std::end(best), comp);
+		}
+	}
+	std::sort_heap(std::begin(best), std::end(best), comp);
+	return best;
+}
 
-	std::cout << "Vector before sort(): ";
+template<typename ForwardIt, typename Compare>
+std::vector<std::iter_value_t<ForwardIt>> smallest_k_select(ForwardIt first, ForwardIt last, std::size_t k, Compare comp)
+{
+	std::vector<std::iter_value_t<ForwardIt>> all(first, last);
+	k = std::min(k, all.size());
+	auto kth = std::begin(all) + static_cast<std::ptrdiff_t>(k);
+	std::nth_element(std::begin(all), kth, std::end(all), comp);
+	all.erase(kth, std::end(all));
+	std::sort(std::begin(all), std::end(all), comp);
+	return all;
+}
 
-	for (auto name : names)
-		std::cout << name << ", ";
-	std::cout << std::endl << std::endl;
+template<typename ForwardIt, typename Compare = std::less<>>
+std::vector<std::iter_value_t<ForwardIt>> smallest_k(ForwardIt first, ForwardIt last, std::size_t k, Compare comp = Compare())
+{
+	if (k <= top_k_heap_limit)
+		return smallest_k_heap(first, last, k, comp);
+	return smallest_k_select(first, last, k, comp);
+}
 
+template<typename ForwardIt, typename Compare = std::less<>>
+std::vector<std::iter_value_t<ForwardIt>> largest_k(ForwardIt first, ForwardIt last, std::size_t k, Compare comp = Compare())
+{
+	return smallest_k(first, last, k, flipped<Compare>(comp));
+}
 
-	greater_than_5 long_enough;
-	for (auto name : names) {
-		if (long_enough(name))
-		{
-			std::cout << "Loop: the first name with > 5 letters is: \"" << name << "\"\n";
-			break;
-		}
+template<typename RandomIt, typename Compare = std::less<>>
+std::vector<std::iter_value_t<RandomIt>> parallel_smallest_k(RandomIt first, RandomIt last, std::size_t k,
+	Compare comp = Compare(), unsigned threads = std::thread::hardware_concurrency())
+{
+	const auto n = static_cast<std::size_t>(last - first);
+	threads = std::max(1u, threads);
+	if (threads == 1 || n < 4 * k * threads)
+		return smallest_k(first, last, k, comp);
+
+	std::vector<std::vector<std::iter_value_t<RandomIt>>> partial(threads);
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t) {
+		auto b = first + static_cast<std::ptrdiff_t>(n * t / threads);
+		auto e = first + static_cast<std::ptrdiff_t>(n * (t + 1) / threads);
+		workers.emplace_back([&partial, t, b, e, k, comp] { partial[t] = smallest_k(b, e, k, comp); });
 	}
+	for (auto& w : workers)
+		w.join();
+
+	std::vector<std::iter_value_t<RandomIt>> candidates;
+	candidates.reserve(k * threads);
+	for (auto& part : partial)
+		candidates.insert(std::end(candidates), std::make_move_iterator(std::begin(part)), std::make_move_iterator(std::end(part)));
+	return smallest_k(std::begin(candidates), std::end(candidates), k, comp);
+}
 
-	// Find the first object with more than 5 characters
-	// pass a functor object as a predicate
-
-	auto res = std::find_if(std::cbegin(names), std::cend(names), greater_than_5());
-
-	//Display it: 
-	if (res != std::cend(names))
-		std::cout << "Algorithm: the first name with > 5 characters is \"" << *res << "\"\n";
+void top_k_Example()
+{
+	std::vector<std::string> names = { "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili", "Rebecca-Jane" };
 
-	//Find first object with less than or equal to 5 characters
-	auto res2 = std::find_if_not(std::cbegin(names), std::cend(names), greater_than_5());
+	std::cout << "\nnames: ";
+	for (const auto& name : names)
+		std::cout << name << ", ";
 
-	//Display it: 
-	if (res2 != std::cend(names))
-		std::cout << "Algorithm: the first name with <= 5 characters is \"" << *res2 << "\"\n";
+	std::cout << "\nthe 3 shortest names (is_shorter): ";
+	for (const auto& name : smallest_k(std::cbegin(names), std::cend(names), 3, is_shorter))
+		std::cout << name << ", ";
 
+	std::cout << "\nthe 3 longest names (is_shorter_2): ";
+	for (const auto& name : largest_k(std::cbegin(names), std::cend(names), 3, is_shorter_2()))
+		std::cout << name << ", ";
 
+	std::cout << "\nthe first 2 names alphabetically: ";
+	for (const auto& name : smallest_k(std::cbegin(names), std::cend(names), 2))
+		std::cout << name << ", ";
+	std::cout << std::endl;
+}
 
-	/*-------------------------------------------------------*/
+void top_k_benchmark(std::size_t n = 5000000)
+{
+	std::mt19937 rng(7);
+	std::vector<std::string> names(n);
+	for (auto& name : names)
+		name = std::string(1 + rng() % 40, static_cast<char>('a' + rng() % 26));
+
+	std::cout << "\nthe k longest of " << n << " names, comparator is_shorter\n";
+
+	for (std::size_t k : { 10, 100, 1000, 100000 }) {
+		std::vector<std::string> sorted, heap, select, parallel;
+
+		double t_heap = elapsed_ms([&] { heap = smallest_k_heap(std::cbegin(names), std::cend(names), k, flipped(is_shorter)); });
+		double t_select = elapsed_ms([&] { select = smallest_k_select(std::cbegin(names), std::cend(names), k, flipped(is_shorter)); });
+		double t_parallel = elapsed_ms([&] { parallel = parallel_smallest_k(std::cbegin(names), std::cend(names), k, flipped(is_shorter)); });
+		double t_sort = elapsed_ms([&] {
+			sorted = names;
+			std::sort(std::begin(sorted), std::end(sorted), flipped(is_shorter));
+			sorted.resize(k);
+		});
+
+		// ties mean different elements can be picked, so compare the lengths
+		auto lengths = [](const std::vector<std::string>& v) {
+			std::vector<std::size_t> res;
+			for (const auto& s : v)
+				res.push_back(s.size());
+			return res;
+		};
+		bool same = lengths(sorted) == lengths(heap) && lengths(sorted) == lengths(select) && lengths(sorted) == lengths(parallel);
+
+		std::cout << "k = " << k << ": full std::sort " << t_sort << " ms, heap " << t_heap << " ms, nth_element + sort "
+			<< t_select << " ms, parallel " << t_parallel << " ms" << (same ? "" : " MISMATCH") << "\n";
+	}
+}
 
+// 
+// SET OPERATIONS ON SORTED VECTORS
+// 
+// Once sorting() has put the names in order, comparing two lists does not need a hash table:
+//		std::unique()				drops adjacent duplicates
+//		std::set_intersection()		the elements in both lists
+//		std::set_difference()		the elements in the first list which are not in the second
+//		std::merge()				both lists, still sorted
+// 
+// The std versions walk both inputs one element at a time. Two things make them faster on big lists:
+// 
+//		- galloping (exponential) search: when one list is much shorter, look ahead 1, 2, 4, 8... elements
+//		  in the long list, then binary search the last step. Runs that have no match in the other list
+//		  are skipped in O(log run) instead of O(run)
+//		- splitters: take a few values from the longer list, std::lower_bound() them in both lists, and
+//		  every pair of pieces can be handled by its own thread. Equal elements always land in the same piece
+// 
+// For int keys the last few steps of a search are done with SSE2, counting 4 "less than" at a time,
+// and unique() compares 4 neighbours at once
+// 
+// Like the std versions the results follow the multiset rules: an element in the first list m times and
+// in the second n times is in the intersection min(m, n) times and in the difference max(m - n, 0) times
+//
 
-	//When we call the algorithm with the state, we need to perovide an object and pass numebr into constructor 
-	auto res3 = find_if(cbegin(names), cend(names), ge_n(8));	// 11 max for this example
+inline constexpr std::size_t gallop_ratio{ 32 };				// use galloping once one input is this many times longer
+inline constexpr std::size_t parallel_set_min{ 1 << 16 };		// elements per thread below which threads cost more than they save
 
-	// Display it
-	if (res3 != cend(names))
-		std::cout << "The first word with > 5 characters is \"" << *res3 << "\"\n";
+// the first element for which pred is false, pred must be true for a prefix of the range
+template<typename RandomIt, typename Pred>
+RandomIt gallop_partition_point(RandomIt first, RandomIt last, Pred pred)
+{
+	const auto n = last - first;
+	if (n == 0 || !pred(first[0]))
+		return first;
+	std::ptrdiff_t bound{ 1 };
+	while (bound < n && pred(first[bound]))
+		bound *= 2;
+	// pred(first[bound / 2]) is true, first[bound] is past the end or false
+	return std::partition_point(first + bound / 2 + 1, first + std::min(bound, n), pred);
+}
 
+template<typename RandomIt, typename T, typename Compare>
+RandomIt gallop_lower_bound(RandomIt first, RandomIt last, const T& value, Compare comp)
+{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	if constexpr (std::is_same_v<std::iter_value_t<RandomIt>, int> && std::is_same_v<T, int> &&
+		(std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<int>>)) {
+		const auto n = last - first;
+		if (n == 0 || first[0] >= value)
+			return first;
+		std::ptrdiff_t bound{ 1 };
+		while (bound < n && first[bound] < value)
+			bound *= 2;
+		const int* lo = &*first + bound / 2 + 1;
+		const int* hi = &*first + std::min(bound, n);
+		if (hi - lo > 64)
+			return first + (std::lower_bound(lo, hi, value) - &*first);
+
+		// the window is sorted, so the answer is lo + (how many are less than value)
+		const __m128i key = _mm_set1_epi32(value);
+		std::ptrdiff_t less{ 0 };
+		const int* p = lo;
+		for (; p + 4 <= hi; p += 4) {
+			__m128i lt = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), key);
+			less += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(lt))));
+		}
+		for (; p < hi; ++p)
+			less += (*p < value);
+		return first + (lo - &*first) + less;
+	}
+#endif
+	return gallop_partition_point(first, last, [&](const auto& e) { return comp(e, value); });
+}
 
+// one piece of each operation, the skewed cases gallop through the longer input
+template<typename RandomIt, typename OutputIt, typename Compare>
+OutputIt gallop_intersection(RandomIt a, RandomIt a_end, RandomIt b, RandomIt b_end, OutputIt out, Compare comp)
+{
+	const auto na = static_cast<std::size_t>(a_end - a), nb = static_cast<std::size_t>(b_end - b);
+	if (na * gallop_ratio < nb) {
+		for (; a != a_end && b != b_end; ++a) {
+			b = gallop_lower_bound(b, b_end, *a, comp);
+			if (b != b_end && !comp(*a, *b)) {
+				*out++ = *a;
+				++b;
+			}
+		}
+		return out;
+	}
+	if (nb * gallop_ratio < na) {
+		for (; a != a_end && b != b_end; ++b) {
+			a = gallop_lower_bound(a, a_end, *b, comp);
+			if (a != a_end && !comp(*b, *a))
+				*out++ = *a++;
+		}
+		return out;
+	}
+	return std::set_intersection(a, a_end, b, b_end, out, comp);
 }
 
+template<typename RandomIt, typename OutputIt, typename Compare>
+OutputIt gallop_difference(RandomIt a, RandomIt a_end, RandomIt b, RandomIt b_end, OutputIt out, Compare comp)
+{
+	const auto na = static_cast<std::size_t>(a_end - a), nb = static_cast<std::size_t>(b_end - b);
+	if (na * gallop_ratio < nb) {
+		for (; a != a_end; ++a) {
+			b = gallop_lower_bound(b, b_end, *a, comp);
+			if (b != b_end && !comp(*a, *b))
+				++b;
+			else
+				*out++ = *a;
+		}
+		return out;
+	}
+	if (nb * gallop_ratio < na) {
+		for (; b != b_end; ++b) {
+			auto pos = gallop_lower_bound(a, a_end, *b, comp);
+			out = std::copy(a, pos, out);
+			a = (pos != a_end && !comp(*b, *pos)) ? pos + 1 : pos;
+		}
+		return std::copy(a, a_end, out);
+	}
+	return std::set_difference(a, a_end, b, b_end, out, comp);
+}
 
+template<typename RandomIt, typename OutputIt, typename Compare>
+OutputIt gallop_merge(RandomIt a, RandomIt a_end, RandomIt b, RandomIt b_end, OutputIt out, Compare comp)
+{
+	const auto na = static_cast<std::size_t>(a_end - a), nb = static_cast<std::size_t>(b_end - b);
+	// on ties the element of the first range goes first, as in std::merge()
+	if (na * gallop_ratio < nb) {
+		for (; a != a_end; ++a) {
+			auto pos = gallop_lower_bound(b, b_end, *a, comp);
+			out = std::copy(b, pos, out);
+			b = pos;
+			*out++ = *a;
+		}
+		return std::copy(b, b_end, out);
+	}
+	if (nb * gallop_ratio < na) {
+		for (; b != b_end; ++b) {
+			auto pos = gallop_partition_point(a, a_end, [&](const auto& e) { return !comp(*b, e); });
+			out = std::copy(a, pos, out);
+			a = pos;
+			*out++ = *b;
+		}
+		return std::copy(a, a_end, out);
+	}
+	return std::merge(a, a_end, b, b_end, out, comp);
+}
 
-//Lambda Expressions
-// Define a functor for the predicate
-//
+template<typename RandomIt, typename OutputIt, typename Compare>
+OutputIt sorted_unique_copy(RandomIt first, RandomIt last, OutputIt out, Compare comp)
+{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	if constexpr (std::is_same_v<std::iter_value_t<RandomIt>, int> && std::is_pointer_v<OutputIt> &&
+		(std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<int>>)) {
+		if (first == last)
+			return out;
+		const int* p = &*first;
+		const int* end = p + (last - first);
+		*out++ = *p++;
+		for (; p + 4 <= end; p += 4) {
+			// lane i is kept when p[i] differs from p[i - 1]
+			__m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 1));
+			unsigned same = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(cur, prev))));
+			if (same == 0) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out), cur);
+				out += 4;
+			}
+			else if (same != 0xF) {
+				for (int i = 0; i < 4; ++i)
+					if (!(same & (1u << i)))
+						*out++ = p[i];
+			}
+		}
+		for (; p < end; ++p)
+			if (p[-1] != *p)
+				*out++ = *p;
+		return out;
+	}
+#endif
+	if (first == last)
+		return out;
+	auto prev = first;
+	*out++ = *first;
+	for (++first; first != last; prev = first, ++first)
+		if (comp(*prev, *first))
+			*out++ = *first;
+	return out;
+}
 
+// runs fn(t, a_begin, a_end, b_begin, b_end) for every piece, the pieces are cut at values taken from the longer input
+template<typename T, typename Compare, typename Fn>
+void for_each_split(const std::vector<T>& a, const std::vector<T>& b, Compare comp, unsigned threads, Fn fn)
+{
+	const auto& longer = a.size() >= b.size() ? a : b;
+	std::vector<std::size_t> a_cut{ 0 }, b_cut{ 0 };
+	for (unsigned t = 1; t < threads; ++t) {
+		const T& splitter = longer[longer.size() * t / threads];
+		a_cut.push_back(static_cast<std::size_t>(std::lower_bound(std::cbegin(a), std::cend(a), splitter, comp) - std::cbegin(a)));
+		b_cut.push_back(static_cast<std::size_t>(std::lower_bound(std::cbegin(b), std::cend(b), splitter, comp) - std::cbegin(b)));
+	}
+	a_cut.push_back(a.size());
+	b_cut.push_back(b.size());
+
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t)
+		workers.emplace_back([&, t] {
+			fn(t, std::cbegin(a) + a_cut[t], std::cbegin(a) + a_cut[t + 1], std::cbegin(b) + b_cut[t], std::cbegin(b) + b_cut[t + 1]);
+		});
+	for (auto& w : workers)
+		w.join();
+}
 
-class is_odd
+// moves the per-thread pieces into one vector, every thread copies its own piece
+template<typename T>
+std::vector<T> join_pieces(std::vector<std::vector<T>>& pieces)
 {
-public:
-	bool operator() (const int n) const { return (n % 2 == 1); }
-};
+	std::vector<std::size_t> offset(pieces.size() + 1, 0);
+	for (std::size_t t = 0; t < pieces.size(); ++t)
+		offset[t + 1] = offset[t] + pieces[t].size();
+
+	std::vector<T> result(offset.back());
+	std::vector<std::thread> workers;
+	for (std::size_t t = 0; t < pieces.size(); ++t)
+		workers.emplace_back([&, t] {
+			std::move(std::begin(pieces[t]), std::end(pieces[t]), std::begin(result) + offset[t]);
+		});
+	for (auto& w : workers)
+		w.join();
+	return result;
+}
 
-std::vector<int> vec{ 3,1,4,1,5,9 };
+inline unsigned set_threads(std::size_t n, unsigned threads)
+{
+	return std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(n / parallel_set_min + 1)));
+}
 
-void is_ODD()
+template<typename T, typename Compare = std::less<>>
+std::vector<T> parallel_unique(const std::vector<T>& sorted, Compare comp = Compare(), unsigned threads = std::thread::hardware_concurrency())
 {
-	
-	std::cout << "The Fector is as follows : ";
-	for (auto vec : vec)
-		std::cout << vec << ", ";
-	std::cout << std::endl << std::endl;
+	threads = set_threads(sorted.size(), threads);
+	std::vector<T> result(sorted.size());
+	if (threads == 1) {
+		T* end = sorted_unique_copy(std::cbegin(sorted), std::cend(sorted), result.data(), comp);
+		result.resize(static_cast<std::size_t>(end - result.data()));
+		return result;
+	}
 
-	//pass the functor object
-	auto odd_it = std::find_if(std::cbegin(vec), std::cend(vec), is_odd());
+	// a piece may not start in the middle of a run of duplicates: move every cut past the run it lands in
+	std::vector<std::size_t> cut{ 0 };
+	for (unsigned t = 1; t < threads; ++t) {
+		std::size_t c = std::max(cut.back(), sorted.size() * t / threads);
+		if (c > 0 && c < sorted.size()) {
+			const T& before = sorted[c - 1];
+			c = static_cast<std::size_t>(gallop_partition_point(std::cbegin(sorted) + c, std::cend(sorted),
+				[&](const T& e) { return !comp(before, e); }) - std::cbegin(sorted));
+		}
+		cut.push_back(c);
+	}
+	cut.push_back(sorted.size());
+
+	// every piece writes to the same position in result, then the pieces are slid together
+	std::vector<std::size_t> kept(threads);
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t)
+		workers.emplace_back([&, t] {
+			T* out = result.data() + cut[t];
+			kept[t] = static_cast<std::size_t>(sorted_unique_copy(std::cbegin(sorted) + cut[t], std::cbegin(sorted) + cut[t + 1], out, comp) - out);
+		});
+	for (auto& w : workers)
+		w.join();
+
+	std::size_t size{ kept[0] };
+	for (unsigned t = 1; t < threads; ++t) {
+		if (size != cut[t])										// already in place when no duplicates were dropped before it; never self-move
+			std::move(std::begin(result) + cut[t], std::begin(result) + cut[t] + kept[t], std::begin(result) + size);
+		size += kept[t];
+	}
+	result.resize(size);
+	return result;
+}
 
-	//odd_it will be the iterator to the first odd element(if there is one)
-	if (odd_it != cend(vec))
-		std::cout << "First odd element is : " << *odd_it << std::endl;
+template<typename T, typename Compare = std::less<>>
+std::vector<T> parallel_set_intersection(const std::vector<T>& a, const std::vector<T>& b, Compare comp = Compare(),
+	unsigned threads = std::thread::hardware_concurrency())
+{
+	threads = set_threads(std::max(a.size(), b.size()), threads);
+	std::vector<std::vector<T>> pieces(threads);
+	for_each_split(a, b, comp, threads, [&](unsigned t, auto a_first, auto a_last, auto b_first, auto b_last) {
+		gallop_intersection(a_first, a_last, b_first, b_last, std::back_inserter(pieces[t]), comp);
+	});
+	return threads == 1 ? std::move(pieces[0]) : join_pieces(pieces);
 }
 
-void is_ODD_Lambda()
+template<typename T, typename Compare = std::less<>>
+std::vector<T> parallel_set_difference(const std::vector<T>& a, const std::vector<T>& b, Compare comp = Compare(),
+	unsigned threads = std::thread::hardware_concurrency())
 {
-	std::cout << "The Fector is as follows : ";
-	for (auto vec : vec)
-		std::cout << vec << ", ";
-	std::cout << std::endl << std::endl;
+	threads = set_threads(std::max(a.size(), b.size()), threads);
+	std::vector<std::vector<T>> pieces(threads);
+	for_each_split(a, b, comp, threads, [&](unsigned t, auto a_first, auto a_last, auto b_first, auto b_last) {
+		pieces[t].reserve(static_cast<std::size_t>(a_last - a_first));
+		gallop_difference(a_first, a_last, b_first, b_last, std::back_inserter(pieces[t]), comp);
+	});
+	return threads == 1 ? std::move(pieces[0]) : join_pieces(pieces);
+}
 
-	//sort the data with a lambda expression as a predicate
-	auto odd_it = std::find_if
-	(
-		std::cbegin(vec), std::cend(vec),
-		[](int n) {								// lambda expression with one argument
-		return (n % 2 == 1);					// return type deduced as a bool
+template<typename T, typename Compare = std::less<>>
+std::vector<T> parallel_merge(const std::vector<T>& a, const std::vector<T>& b, Compare comp = Compare(),
+	unsigned threads = std::thread::hardware_concurrency())
+{
+	// the size of every piece is known up front, so they are written straight into the result
+	threads = set_threads(a.size() + b.size(), threads);
+	std::vector<T> result(a.size() + b.size());
+	for_each_split(a, b, comp, threads, [&](unsigned, auto a_first, auto a_last, auto b_first, auto b_last) {
+		auto out = std::begin(result) + ((a_first - std::cbegin(a)) + (b_first - std::cbegin(b)));
+		gallop_merge(a_first, a_last, b_first, b_last, out, comp);
 	});
+	return result;
+}
 
+void set_operations_Example()
+{
+	std::vector<std::string> today = { "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili", "Nick" };
+	std::vector<std::string> yesterday = { "Mark", "Pewdie", "KSI", "Cherno", "William", "Stan" };
+	std::sort(std::begin(today), std::end(today));
+	std::sort(std::begin(yesterday), std::end(yesterday));
+
+	auto print = [](const char* title, const std::vector<std::string>& names) {
+		std::cout << title;
+		for (const auto& name : names)
+			std::cout << name << ", ";
+		std::cout << "\n";
+	};
 
-	//odd_it will be the iterator to the first odd element(if there is one)
-	if (odd_it != cend(vec))
-		std::cout << "First odd element is : " << *odd_it << std::endl;
+	std::cout << "\n";
+	print("today: ", today);
+	print("yesterday: ", yesterday);
+	print("unique(today): ", parallel_unique(today));
+	print("in both lists: ", parallel_set_intersection(today, yesterday));
+	print("new today: ", parallel_set_difference(today, yesterday));
+	print("merged: ", parallel_merge(today, yesterday));
 }
 
+void set_operations_benchmark(std::size_t n = 100000000)
+{
+	std::mt19937 rng(11);
+	auto sorted_ints = [&rng](std::size_t count, unsigned range) {
+		std::vector<int> v(count);
+		for (auto& x : v)
+			x = static_cast<int>(rng() % range);
+		std::sort(std::begin(v), std::end(v));
+		return v;
+	};
+
+	const unsigned range = static_cast<unsigned>(std::min<std::size_t>(4 * n, 0x7FFFFFFF));
+	std::vector<int> a = sorted_ints(n, range), b = sorted_ints(n, range), few = sorted_ints(n / 1000, range);
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::cout << "\n" << n << " sorted ints against " << n << " (and against " << few.size() << "), " << threads << " threads\n";
+
+	auto compare = [](const char* name, double t_std, double t_ours, bool same) {
+		std::cout << name << ": std " << t_std << " ms, galloping/parallel " << t_ours << " ms" << (same ? "" : " MISMATCH") << "\n";
+	};
+
+	for (const auto* other : { &b, &few }) {
+		const char* tag = other == &b ? " (same size)" : " (skewed)";
+		std::vector<int> expected, ours;
+
+		double t_std = elapsed_ms([&] {
+			expected = std::vector<int>();
+			std::set_intersection(std::cbegin(a), std::cend(a), std::cbegin(*other), std::cend(*other), std::back_inserter(expected));
+		});
+		double t_ours = elapsed_ms([&] { ours = parallel_set_intersection(a, *other); });
+		compare((std::string("set_intersection") + tag).c_str(), t_std, t_ours, expected == ours);
+
+		t_std = elapsed_ms([&] {
+			expected = std::vector<int>();
+			std::set_difference(std::cbegin(a), std::cend(a), std::cbegin(*other), std::cend(*other), std::back_inserter(expected));
+		});
+		t_ours = elapsed_ms([&] { ours = parallel_set_difference(a, *other); });
+		compare((std::string("set_difference") + tag).c_str(), t_std, t_ours, expected == ours);
+
+		t_std = elapsed_ms([&] {
+			expected = std::vector<int>(a.size() + other->size());
+			std::merge(std::cbegin(a), std::cend(a), std::cbegin(*other), std::cend(*other), std::begin(expected));
+		});
+		t_ours = elapsed_ms([&] { ours = parallel_merge(a, *other); });
+		compare((std::string("merge") + tag).c_str(), t_std, t_ours, expected == ours);
+	}
 
-//Practical lambda implementation demo
+	std::vector<int> expected, ours;
+	double t_std = elapsed_ms([&] {
+		expected = a;
+		expected.erase(std::unique(std::begin(expected), std::end(expected)), std::end(expected));
+	});
+	double t_ours = elapsed_ms([&] { ours = parallel_unique(a); });
+	compare("unique", t_std, t_ours, expected == ours);
+
+	// and the same with names, which have no SIMD path
+	const std::size_t names_n = n / 20;
+	std::vector<std::string> names_a(names_n), names_b(names_n);
+	for (auto* names : { &names_a, &names_b }) {
+		for (auto& name : *names)
+			name = "name" + std::to_string(rng() % (4 * names_n));
+		std::sort(std::begin(*names), std::end(*names));
+	}
+	std::vector<std::string> expected_names, our_names;
+	t_std = elapsed_ms([&] {
+		std::set_intersection(std::cbegin(names_a), std::cend(names_a), std::cbegin(names_b), std::cend(names_b), std::back_inserter(expected_names));
+	});
+	t_ours = elapsed_ms([&] { our_names = parallel_set_intersection(names_a, names_b); });
+	compare((std::string("set_intersection, ") + std::to_string(names_n) + " names").c_str(), t_std, t_ours, expected_names == our_names);
+
+	// the multi-threaded paths move std::strings around, check them with 4 threads even on a smaller machine
+	names_a.erase(std::unique(std::begin(names_a), std::end(names_a)), std::end(names_a));	// no duplicates: every piece is already in place
+	for (const auto* names : { &names_a, &names_b }) {
+		expected_names = *names;
+		expected_names.erase(std::unique(std::begin(expected_names), std::end(expected_names)), std::end(expected_names));
+		bool same = expected_names == parallel_unique(*names, std::less<>(), 4);
+		std::cout << "unique, " << names->size() << " names, 4 threads" << (same ? ": same as std::unique" : " MISMATCH") << "\n";
+	}
+	expected_names.clear();
+	std::set_difference(std::cbegin(names_a), std::cend(names_a), std::cbegin(names_b), std::cend(names_b), std::back_inserter(expected_names));
+	std::cout << "set_difference, 4 threads" << (expected_names == parallel_set_difference(names_a, names_b, std::less<>(), 4) ? ": same as std" : " MISMATCH") << "\n";
+	expected_names.clear();
+	std::merge(std::cbegin(names_a), std::cend(names_a), std::cbegin(names_b), std::cend(names_b), std::back_inserter(expected_names));
+	std::cout << "merge, 4 threads" << (expected_names == parallel_merge(names_a, names_b, std::less<>(), 4) ? ": same as std" : " MISMATCH") << "\n";
+}
 
-//case insensitive string comparison
-//		Suppose we wrote a function that compares two string arguments and ignores case
 // 
-//				- bool equal_strings(const std::string& lhs, const std::string& rhs);
-//					if(equal_strings(str1,str2))....
+// KEEPING THE NAMES SORTED
 // 
-//		We will rework this using a lambda function
-//		We will use the equal()
+// sorting() and sorting_with_object() sort the whole vector every time. If only a few names change
+// between two looks at the sorted list, most of that work is repeated for nothing
 // 
-// equal() ALGORITHM: 
-// equal() used to compare elements in two containers
-//		bool cmp = std::equal(std::cbegin(ct1),std::cend(ct1),std::cbegin(ctd2),std::cend(ct2));
+// delta_sorted_vector keeps:
+//		- a sorted vector, cache friendly, binary searchable
+//		- a small unsorted buffer of pending inserts and one of pending erases
 // 
-// this iterates through each element in container 1, and compares it to the coresponding element in container 2
-// it returns a false as soon as it encounters a mismatch
-//		- if ct1 has more elements than ct2, it will always return false
-//		- if ct2 has more elements than ct1, the extra elements are ignored
+// insert() and erase() only touch the buffers. Asking whether a name is there checks the sorted part with
+// a binary search plus the (small) buffers, so it does not need the buffers merged in first
 // 
-// By default, the == operator is used to compare the elements
-//		- if the containers are std::string, the comparison will be CASE SENSITIVE	
+// sorted() applies the buffers in one pass when someone wants the whole ordered list (or the buffers grow
+// past flush_threshold):
+//		1. sort the buffers, only k log k for k changes
+//		2. walk the vector once, sliding elements over the erased ones
+//		3. std::inplace_merge() the sorted inserts in
+// which is O(n + k log k) instead of the O(n log n) of sorting everything again
+// 
+// sorted_names keeps two of them, one sorted alphabetically and one by is_shorter. is_shorter alone treats
+// all names of the same length as equal, so erasing "Stan" could remove "Nick"; ties are broken alphabetically
+//
+
+template<typename T, typename Compare = std::less<>>
+class delta_sorted_vector {
+private:
+	std::vector<T> items;										// always sorted
+	std::vector<T> pending_insert;
+	std::vector<T> pending_erase;								// only elements which are in items
+	Compare comp;
+	std::size_t flush_threshold;
+
+	bool equivalent(const T& a, const T& b) const { return !comp(a, b) && !comp(b, a); }
+
+	std::size_t count_in(const std::vector<T>& v, const T& value) const
+	{
+		return static_cast<std::size_t>(std::count_if(std::cbegin(v), std::cend(v), [&](const T& x) { return equivalent(x, value); }));
+	}
+
+	std::size_t count_sorted(const T& value) const
+	{
+		auto range = std::equal_range(std::cbegin(items), std::cend(items), value, comp);
+		return static_cast<std::size_t>(range.second - range.first);
+	}
+
+	void flush_if_full()
+	{
+		if (pending_insert.size() + pending_erase.size() >= flush_threshold)
+			flush();
+	}
+
+public:
+	explicit delta_sorted_vector(Compare comp = Compare(), std::size_t flush_threshold = 1024)
+		: comp(comp), flush_threshold(flush_threshold) {}
+
+	template<typename InputIt>
+	delta_sorted_vector(InputIt first, InputIt last, Compare comp = Compare(), std::size_t flush_threshold = 1024)
+		: items(first, last), comp(comp), flush_threshold(flush_threshold)
+	{
+		std::sort(std::begin(items), std::end(items), comp);
+	}
+
+	void insert(T value)
+	{
+		pending_insert.push_back(std::move(value));
+		flush_if_full();
+	}
+
+	// removes one element equivalent to value, returns false if there was none
+	bool erase(const T& value)
+	{
+		auto it = std::find_if(std::begin(pending_insert), std::end(pending_insert), [&](const T& x) { return equivalent(x, value); });
+		if (it != std::end(pending_insert)) {
+			*it = std::move(pending_insert.back());
+			pending_insert.pop_back();
+			return true;
+		}
+		if (count_sorted(value) <= count_in(pending_erase, value))
+			return false;
+		pending_erase.push_back(value);
+		flush_if_full();
+		return true;
+	}
+
+	std::size_t count(const T& value) const
+	{
+		return count_sorted(value) - count_in(pending_erase, value) + count_in(pending_insert, value);
+	}
+
+	bool contains(const T& value) const
+	{
+		if (count_sorted(value) > count_in(pending_erase, value))
+			return true;
+		return std::any_of(std::cbegin(pending_insert), std::cend(pending_insert), [&](const T& x) { return equivalent(x, value); });
+	}
+
+	std::size_t size() const { return items.size() - pending_erase.size() + pending_insert.size(); }
+
+	std::size_t pending() const { return pending_insert.size() + pending_erase.size(); }
+
+	void flush()
+	{
+		if (!pending_erase.empty()) {
+			std::sort(std::begin(pending_erase), std::end(pending_erase), comp);
+			auto read = std::begin(items), write = std::begin(items);
+			for (const auto& value : pending_erase) {
+				auto pos = gallop_lower_bound(read, std::end(items), value, comp);
+				write = (write == read) ? pos : std::move(read, pos, write);
+				read = pos + 1;									// erase() made sure it is there
+			}
+			write = (write == read) ? std::end(items) : std::move(read, std::end(items), write);
+			items.erase(write, std::end(items));
+			pending_erase.clear();
+		}
+		if (!pending_insert.empty()) {
+			std::sort(std::begin(pending_insert), std::end(pending_insert), comp);
+			const auto old_size = static_cast<std::ptrdiff_t>(items.size());
+			items.insert(std::end(items), std::make_move_iterator(std::begin(pending_insert)), std::make_move_iterator(std::end(pending_insert)));
+			std::inplace_merge(std::begin(items), std::begin(items) + old_size, std::end(items), comp);
+			pending_insert.clear();
+		}
+	}
+
+	const std::vector<T>& sorted()
+	{
+		flush();
+		return items;
+	}
+};
+
+// is_shorter, ties broken alphabetically so that different names are never equivalent
+struct shorter_then_alphabetical {
+	bool operator() (std::string_view lhs, std::string_view rhs) const
+	{
+		if (lhs.size() != rhs.size())
+			return is_shorter(lhs, rhs);
+		return lhs < rhs;
+	}
+};
+
+class sorted_names {
+private:
+	delta_sorted_vector<std::string> by_name;
+	delta_sorted_vector<std::string, shorter_then_alphabetical> by_size;
+public:
+	sorted_names() = default;
+	template<typename InputIt>
+	sorted_names(InputIt first, InputIt last) : by_name(first, last), by_size(first, last) {}
+	sorted_names(std::initializer_list<std::string> names) : sorted_names(std::begin(names), std::end(names)) {}
+
+	void insert(const std::string& name)
+	{
+		by_name.insert(name);
+		by_size.insert(name);
+	}
+
+	bool erase(const std::string& name)
+	{
+		if (!by_name.erase(name))
+			return false;
+		by_size.erase(name);
+		return true;
+	}
+
+	bool contains(const std::string& name) const { return by_name.contains(name); }
+	std::size_t size() const { return by_name.size(); }
+
+	const std::vector<std::string>& alphabetical() { return by_name.sorted(); }
+	const std::vector<std::string>& by_length() { return by_size.sorted(); }
+};
+
+void sorted_names_Example()
+{
+	sorted_names names = { "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili" };
+
+	auto print = [](const char* title, const std::vector<std::string>& v) {
+		std::cout << title;
+		for (const auto& name : v)
+			std::cout << name << ", ";
+		std::cout << "\n";
+	};
+
+	std::cout << "\n";
+	print("alphabetical: ", names.alphabetical());
+	print("by length: ", names.by_length());
+
+	// no sorting here, the changes wait in the buffers
+	names.insert("Mark");
+	names.insert("KSI");
+	names.erase("Stan");
+	std::cout << "\nafter inserting Mark and KSI and erasing Stan, contains(\"KSI\") = " << std::boolalpha << names.contains("KSI")
+		<< ", contains(\"Stan\") = " << names.contains("Stan") << std::noboolalpha << "\n";
+
+	// the first look at the whole list merges them in
+	print("alphabetical: ", names.alphabetical());
+	print("by length: ", names.by_length());
+}
+
+void sorted_names_benchmark(std::size_t n = 1000000, std::size_t batch = 1000, int batches = 20)
+{
+	std::mt19937 rng(5);
+	auto random_name = [&rng] {
+		std::string name(3 + rng() % 10, ' ');
+		for (auto& c : name)
+			c = static_cast<char>('a' + rng() % 26);
+		return name;
+	};
+
+	std::vector<std::string> initial(n);
+	for (auto& name : initial)
+		name = random_name();
+
+	std::vector<std::string> resorted = initial;				// the old way: a plain vector, sorted again after every batch
+	std::sort(std::begin(resorted), std::end(resorted));
+	sorted_names incremental(std::cbegin(initial), std::cend(initial));
+
+	std::cout << "\n" << n << " names, " << batches << " batches of " << batch << " inserts + " << batch << " erases, then both orderings\n";
+
+	double t_resort{ 0 }, t_incremental{ 0 };
+	bool same{ true };
+	for (int b = 0; b < batches; ++b) {
+		std::vector<std::string> added(batch), removed(batch);
+		for (auto& name : added)
+			name = random_name();
+		for (auto& name : removed)
+			name = resorted[rng() % resorted.size()];
+
+		t_resort += elapsed_ms([&] {
+			std::vector<std::string> kept;
+			kept.reserve(resorted.size() + added.size());
+			std::sort(std::begin(removed), std::end(removed));
+			std::set_difference(std::make_move_iterator(std::begin(resorted)), std::make_move_iterator(std::end(resorted)),
+				std::cbegin(removed), std::cend(removed), std::back_inserter(kept));
+			kept.insert(std::end(kept), std::cbegin(added), std::cend(added));
+			resorted = std::move(kept);
+			std::sort(std::begin(resorted), std::end(resorted), shorter_then_alphabetical());
+			std::sort(std::begin(resorted), std::end(resorted));
+		});
+
+		t_incremental += elapsed_ms([&] {
+			for (const auto& name : added)
+				incremental.insert(name);
+			for (const auto& name : removed)
+				incremental.erase(name);
+			incremental.by_length();
+			incremental.alphabetical();
+		});
+
+		same = same && resorted == incremental.alphabetical();
+	}
+
+	std::cout << "full re-sort: " << t_resort / batches << " ms per batch, delta buffer + merge: " << t_incremental / batches
+		<< " ms per batch" << (same ? "" : " MISMATCH") << "\n";
+
+	// point queries do not need the buffers merged first
+	for (int i = 0; i < 100; ++i)
+		incremental.insert(random_name());
+	std::size_t found{ 0 };
+	double t_query = elapsed_ms([&] {
+		for (std::size_t i = 0; i < 1000000; ++i)
+			found += incremental.contains(initial[i % initial.size()]);
+	});
+	std::cout << "1M contains() with 100 pending inserts: " << t_query << " ms (" << found << " found)\n";
+}
+
+// Algorithms with predicates:
+//	Many algorithms call a function on each element which returns bool
+//		- find() calls  the == operator for each element to compare it to the target value
+// 
+// this is known as a "Predicate"
+// 
+// These algorithms allow us to supply our own predicate
+// 
+// We can pass a callable object as an optional extra argument to the algorithm call
+// 
+// 
+// std::sort();
+// 
+// the sort algorithm works by comparing pairs of elements
+// the comparison is called by calling the elements < operator on each pair of elements
+// 
+// sort() moves the smallest elements to the front and the largest to the rear of
+// the container (by a clever choice of which pairs to compare, the sort can be very efficient.
+// 
+// 
+// 
+//
+// --------------------------------------------------------------------------------------------
+// 
+// Algorithms with _if versions:
+//		Many Algorithms have two versions
+//			- the base version which takes a value argument
+//			- An _if version which takes a predicate argument
+// 
+//		find() takes a value and searches for the first element with it's value
+//		find_if() takes a predicate function and searches for the first element 
+//	for which this predicate returns true
+// 
+//		we can use a functor to provide this predicate
+// 
+// 
+
+// Functor for _if predicate explicit
+class greater_than_5 {
+public:
+	bool operator () (std::string_view s) const {
+		return (s.size() > 5);
+	}
+};
+
+// Functor for _if predicate of any number
+//suppose we want to look for any number of characters
+// we do that by adding a state to our functor
+
+class ge_n {
+private:
+	const int n;
+public:
+	ge_n(const int n) : n(n) {}
+
+	bool operator () (std::string_view str) const {
+		return str.size() > n;
+	}
+};
+
+// Compile time thresholds
+// 
+// ge_n keeps n in a data member, and a lambda like [n](auto& s) {return s.size() > n; } does the same,
+// so the compiler only sees "compare with whatever is in memory"
+// 
+// If the threshold is a template parameter instead, it is a constant in the generated code
+//		greater_than<5>() is the same test as greater_than_5(), but written once for every N
+// 
+// len_gt<N>, len_lt<N> and len_eq<N> are ready made objects, and they can be combined:
+//		len_gt<5> && !len_gt<10>			longer than 5 but not longer than 10
+// the combination is a new functor type, worked out at compile time (constexpr)
+//		- && and || use the bitwise & and |, so there is no branch per element and a
+//		  count_if() over the lengths can be vectorised
+//
+
+template<typename P>
+concept length_predicate = requires { P::is_length_predicate; };
+
+template<std::size_t N>
+struct greater_than {
+	static constexpr bool is_length_predicate{ true };
+	constexpr bool operator () (std::string_view str) const { return str.size() > N; }
+};
+
+template<std::size_t N>
+struct shorter_than {
+	static constexpr bool is_length_predicate{ true };
+	constexpr bool operator () (std::string_view str) const { return str.size() < N; }
+};
+
+template<std::size_t N>
+struct length_is {
+	static constexpr bool is_length_predicate{ true };
+	constexpr bool operator () (std::string_view str) const { return str.size() == N; }
+};
+
+template<length_predicate L, length_predicate R>
+struct and_predicate {
+	static constexpr bool is_length_predicate{ true };
+	L lhs; R rhs;
+	constexpr bool operator () (std::string_view str) const { return lhs(str) & rhs(str); }
+};
+
+template<length_predicate L, length_predicate R>
+struct or_predicate {
+	static constexpr bool is_length_predicate{ true };
+	L lhs; R rhs;
+	constexpr bool operator () (std::string_view str) const { return lhs(str) | rhs(str); }
+};
+
+template<length_predicate P>
+struct not_predicate {
+	static constexpr bool is_length_predicate{ true };
+	P pred;
+	constexpr bool operator () (std::string_view str) const { return !pred(str); }
+};
+
+template<length_predicate L, length_predicate R>
+constexpr and_predicate<L, R> operator&& (L lhs, R rhs) { return { lhs, rhs }; }
+
+template<length_predicate L, length_predicate R>
+constexpr or_predicate<L, R> operator|| (L lhs, R rhs) { return { lhs, rhs }; }
+
+template<length_predicate P>
+constexpr not_predicate<P> operator! (P pred) { return { pred }; }
+
+template<std::size_t N> inline constexpr greater_than<N> len_gt{};
+template<std::size_t N> inline constexpr shorter_than<N> len_lt{};
+template<std::size_t N> inline constexpr length_is<N> len_eq{};
+
+static_assert((len_gt<5> && !len_gt<10>)("Benjamin"), "8 letters is between 5 and 10");
+static_assert(!(len_gt<5> && !len_gt<10>)("Rebecca-Jane"), "12 letters is not");
+static_assert((len_lt<3> || len_eq<4>)("Nick"), "4 letters");
+
+// Runtime to compile time dispatch
+//		the threshold often comes from input, but is usually small
+//		call f(greater_than<n>()) when n < max_fixed_length, otherwise f(ge_n(n))
+//
+inline constexpr std::size_t max_fixed_length{ 32 };
+
+template<typename Func, std::size_t... Ns>
+decltype(auto) dispatch_greater_than_impl(std::size_t n, Func&& f, std::index_sequence<Ns...>)
+{
+	using result_type = decltype(f(ge_n(0)));
+	if constexpr (std::is_void_v<result_type>) {
+		if (!((n == Ns ? (f(greater_than<Ns>()), true) : false) || ...))
+			f(ge_n(static_cast<int>(n)));
+	}
+	else {
+		result_type res{};
+		if (!((n == Ns ? (res = f(greater_than<Ns>()), true) : false) || ...))
+			res = f(ge_n(static_cast<int>(n)));
+		return res;
+	}
+}
+
+template<typename Func>
+decltype(auto) dispatch_greater_than(std::size_t n, Func&& f)
+{
+	return dispatch_greater_than_impl(n, std::forward<Func>(f), std::make_index_sequence<max_fixed_length>());
+}
+
+void fixed_length_predicate_benchmark(std::size_t n = 100000000)
+{
+	// string_views of random length into one shared buffer, so 100M "strings" fit in memory
+	static const std::string letters(64, 'x');
+	std::mt19937 rng(3);
+	std::vector<std::string_view> words(n);
+	for (auto& w : words)
+		w = std::string_view(letters.data(), rng() % 20);
+
+	std::cout << "\ncount_if() over " << n << " strings\n";
+
+	int min{ 5 }, max{ 10 };
+	std::ptrdiff_t c1{ 0 }, c2{ 0 }, c3{ 0 }, c4{ 0 }, c5{ 0 }, c6{ 0 };
+
+	double t1 = elapsed_ms([&] { c1 = std::count_if(std::cbegin(words), std::cend(words), ge_n(min)); });
+	double t2 = elapsed_ms([&] { c2 = std::count_if(std::cbegin(words), std::cend(words), greater_than_5()); });
+	double t3 = elapsed_ms([&] { c3 = std::count_if(std::cbegin(words), std::cend(words), len_gt<5>); });
+	double t4 = elapsed_ms([&] {
+		c4 = std::count_if(std::cbegin(words), std::cend(words),
+			[min = static_cast<std::size_t>(min), max = static_cast<std::size_t>(max)](std::string_view s) {return s.size() > min && !(s.size() > max); });
+	});
+	double t5 = elapsed_ms([&] { c5 = std::count_if(std::cbegin(words), std::cend(words), len_gt<5> && !len_gt<10>); });
+	double t6 = elapsed_ms([&] {
+		c6 = dispatch_greater_than(min, [&words](auto pred) { return std::count_if(std::cbegin(words), std::cend(words), pred); });
+	});
+
+	std::cout << "> 5,  runtime ge_n(min)                  : " << t1 << " ms (" << c1 << ")\n"
+		<< "> 5,  greater_than_5()                   : " << t2 << " ms (" << c2 << ")\n"
+		<< "> 5,  len_gt<5>                          : " << t3 << " ms (" << c3 << ")\n"
+		<< "> 5,  dispatch_greater_than(min, ...)    : " << t6 << " ms (" << c6 << ")\n"
+		<< "5-10, lambda capturing [min, max]        : " << t4 << " ms (" << c4 << ")\n"
+		<< "5-10, len_gt<5> && !len_gt<10>           : " << t5 << " ms (" << c5 << ")\n";
+}
+
+
+
+
+void _if_Finder()
+{
+	//manually coded example
+	std::vector<std::string> names = { "AJ","Jeny", "Dax", "Wally", "Allice", "Michael", "Kim","Jo", "Nataliana","Rebecca-Jane"};
+
+	std::cout << "Vector before sort(): ";
+
+	for (const auto& name : names)
+		std::cout << name << ", ";
+	std::cout << std::endl << std::endl;
+
+
+	greater_than_5 long_enough;
+	for (const auto& name : names) {
+		if (long_enough(name))
+		{
+			std::cout << "Loop: the first name with > 5 letters is: \"" << name << "\"\n";
+			break;
+		}
+	}
+
+	// Find the first object with more than 5 characters
+	// pass a functor object as a predicate
+
+	auto res = std::find_if(std::cbegin(names), std::cend(names), greater_than_5());
+
+	//Display it: 
+	if (res != std::cend(names))
+		std::cout << "Algorithm: the first name with > 5 characters is \"" << *res << "\"\n";
+
+	//Find first object with less than or equal to 5 characters
+	auto res2 = std::find_if_not(std::cbegin(names), std::cend(names), greater_than_5());
+
+	//Display it: 
+	if (res2 != std::cend(names))
+		std::cout << "Algorithm: the first name with <= 5 characters is \"" << *res2 << "\"\n";
+
+
+
+	/*-------------------------------------------------------*/
+
+
+	//When we call the algorithm with the state, we need to perovide an object and pass numebr into constructor 
+	auto res3 = find_if(cbegin(names), cend(names), ge_n(8));	// 11 max for this example
+
+	// Display it
+	if (res3 != cend(names))
+		std::cout << "The first word with > 5 characters is \"" << *res3 << "\"\n";
+
+
+}
+
+
+
+//Lambda Expressions
+// Define a functor for the predicate
+//
+
+
+class is_odd
+{
+public:
+	bool operator() (const int n) const { return (n % 2 == 1); }
+};
+
+std::vector<int> vec{ 3,1,4,1,5,9 };
+
+void is_ODD()
+{
+	
+	std::cout << "The Fector is as follows : ";
+	for (auto vec : vec)
+		std::cout << vec << ", ";
+	std::cout << std::endl << std::endl;
+
+	//pass the functor object
+	auto odd_it = std::find_if(std::cbegin(vec), std::cend(vec), is_odd());
+
+	//odd_it will be the iterator to the first odd element(if there is one)
+	if (odd_it != cend(vec))
+		std::cout << "First odd element is : " << *odd_it << std::endl;
+}
+
+void is_ODD_Lambda()
+{
+	std::cout << "The Fector is as follows : ";
+	for (auto vec : vec)
+		std::cout << vec << ", ";
+	std::cout << std::endl << std::endl;
+
+	//sort the data with a lambda expression as a predicate
+	auto odd_it = std::find_if
+	(
+		std::cbegin(vec), std::cend(vec),
+		[](int n) {								// lambda expression with one argument
+		return (n % 2 == 1);					// return type deduced as a bool
+	});
+
+
+	//odd_it will be the iterator to the first odd element(if there is one)
+	if (odd_it != cend(vec))
+		std::cout << "First odd element is : " << *odd_it << std::endl;
+}
+
+
+// 
+// SHARING vec BETWEEN THREADS
+// 
+// is_ODD() and is_ODD_Lambda() read the global vec. If another thread replaces the data while
+// find_if() is running, the reader can see a half updated vector or a freed buffer
+// 
+// snapshot_vector keeps the data in an immutable std::vector and publishes new versions by
+// swapping an atomic pointer (the read-copy-update idea)
+//		- a reader takes a snapshot: it gets a consistent, unchanging view without taking a lock,
+//		  and keeps it for as long as it needs
+//		- a writer builds a new vector, swaps the pointer, and puts the old version on a retired list
+//		- old versions are deleted later, once no reader can still be looking at them
+// 
+// How do we know? Epochs
+//		- there is a global epoch counter. A reader writes the current epoch into a slot of its own
+//		  before it loads the pointer, and clears the slot when the snapshot is released
+//		- the writer retires the old version with the epoch it had, then moves the epoch on
+//		- a retired version can be deleted once every busy reader slot shows a LATER epoch,
+//		  because those readers started after the swap and can only have seen the new version
+// 
+// There are max_readers (64) slots. Snapshots beyond that, whether held by 65 threads or all by one,
+// are not refused: they register their epoch in a small mutex protected overflow table instead,
+// which reclaim() checks too. Reads stay lock free as long as no more than 64 snapshots are alive at once
+//
+
+template<typename T>
+class snapshot_vector {
+private:
+	static constexpr std::size_t max_readers{ 64 };				// live snapshots with a lock free slot, more use the overflow table
+
+	struct alignas(64) reader_slot {							// one cache line each, so readers do not fight over lines
+		std::atomic<std::uint64_t> epoch{ 0 };					// 0 = not reading
+	};
+
+	struct retired_version {
+		const std::vector<T>* data;
+		std::uint64_t epoch;
+	};
+
+	std::atomic<const std::vector<T>*> current;
+	std::atomic<std::uint64_t> global_epoch{ 1 };
+	std::array<reader_slot, max_readers> slots;
+	std::mutex writer_mutex;									// writers are serialised, readers never touch it
+	std::vector<retired_version> retired;
+
+	std::mutex overflow_mutex;									// only used when all the slots are busy
+	std::map<std::uint64_t, std::size_t> overflow_epochs;		// epoch -> snapshots outside the slots reading since then
+
+	void leave_overflow(std::uint64_t epoch) {
+		std::lock_guard<std::mutex> lock(overflow_mutex);
+		auto it = overflow_epochs.find(epoch);
+		if (--it->second == 0)
+			overflow_epochs.erase(it);
+	}
+
+	void reclaim() {
+		std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+		for (auto& slot : slots) {
+			auto e = slot.epoch.load();
+			if (e != 0)
+				oldest = std::min(oldest, e);
+		}
+		{
+			std::lock_guard<std::mutex> lock(overflow_mutex);
+			if (!overflow_epochs.empty())
+				oldest = std::min(oldest, overflow_epochs.begin()->first);
+		}
+		auto keep = std::partition(std::begin(retired), std::end(retired),
+			[oldest](const retired_version& r) {return r.epoch >= oldest; });
+		for (auto it = keep; it != std::end(retired); ++it)
+			delete it->data;
+		retired.erase(keep, std::end(retired));
+	}
+
+public:
+	// a consistent view of the data, valid until the snapshot is destroyed
+	class snapshot {
+	private:
+		reader_slot* slot;
+		const std::vector<T>* data;
+		snapshot_vector* overflow_owner{ nullptr };				// set instead of slot when the snapshot lives in the overflow table
+		std::uint64_t overflow_epoch{ 0 };
+		friend class snapshot_vector;
+		snapshot(reader_slot* slot, const std::vector<T>* data) : slot(slot), data(data) {}
+		snapshot(snapshot_vector* owner, std::uint64_t epoch, const std::vector<T>* data)
+			: slot(nullptr), data(data), overflow_owner(owner), overflow_epoch(epoch) {}
+	public:
+		snapshot(const snapshot&) = delete;
+		snapshot& operator= (const snapshot&) = delete;
+		snapshot(snapshot&& other) noexcept
+			: slot(std::exchange(other.slot, nullptr)), data(other.data),
+			overflow_owner(std::exchange(other.overflow_owner, nullptr)), overflow_epoch(other.overflow_epoch) {}
+		~snapshot() {
+			if (slot)
+				slot->epoch.store(0, std::memory_order_release);
+			else if (overflow_owner)
+				overflow_owner->leave_overflow(overflow_epoch);
+		}
+
+		const std::vector<T>& operator* () const { return *data; }
+		const std::vector<T>* operator-> () const { return data; }
+		auto begin() const { return data->cbegin(); }
+		auto end() const { return data->cend(); }
+	};
+
+	explicit snapshot_vector(std::vector<T> initial = {}) : current(new std::vector<T>(std::move(initial))) {}
+
+	snapshot_vector(const snapshot_vector&) = delete;
+	snapshot_vector& operator= (const snapshot_vector&) = delete;
+
+	~snapshot_vector() {
+		delete current.load();
+		for (auto& r : retired)
+			delete r.data;
+	}
+
+	// lock free while a reader slot is free: claims it, no mutex and no shared counter is written
+	// after one full pass with every slot busy, the snapshot is registered in the overflow table under its mutex
+	snapshot read() {
+		thread_local std::size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+		for (std::size_t i = 0; i < max_readers; ++i) {
+			reader_slot& slot = slots[(hint + i) % max_readers];
+			std::uint64_t expected{ 0 };
+			if (slot.epoch.load(std::memory_order_relaxed) == 0 && slot.epoch.compare_exchange_strong(expected, global_epoch.load())) {
+				hint = (hint + i) % max_readers;
+				return snapshot(&slot, current.load());
+			}
+		}
+
+		std::uint64_t epoch;
+		{
+			std::lock_guard<std::mutex> lock(overflow_mutex);
+			epoch = global_epoch.load();
+			++overflow_epochs[epoch];
+		}
+		return snapshot(this, epoch, current.load());
+	}
+
+private:
+	// writer_mutex must be held
+	void publish_locked(std::vector<T> data) {
+		auto fresh = new std::vector<T>(std::move(data));
+		auto old = current.exchange(fresh);
+		retired.push_back({ old, global_epoch.fetch_add(1) });
+		reclaim();
+	}
+
+public:
+	void publish(std::vector<T> data) {
+		std::lock_guard<std::mutex> lock(writer_mutex);
+		publish_locked(std::move(data));
+	}
+
+	// copy the current version, let f change the copy, publish the result
+	// all three happen under writer_mutex, so two concurrent updates cannot start from the same
+	// version and lose one change. Only writers wait for f, readers never do
+	template<typename Func>
+	void update(Func f) {
+		std::lock_guard<std::mutex> lock(writer_mutex);
+		std::vector<T> copy = *current.load();					// only writers replace current, and we are the writer
+		f(copy);
+		publish_locked(std::move(copy));
+	}
+
+	std::size_t pending_reclaim() {
+		std::lock_guard<std::mutex> lock(writer_mutex);
+		return retired.size();
+	}
+};
+
+snapshot_vector<int> shared_vec{ vec };
+
+void is_ODD_Snapshot()
+{
+	auto snap = shared_vec.read();									// this view cannot change under us
+
+	std::cout << "The snapshot is as follows : ";
+	for (auto v : snap)
+		std::cout << v << ", ";
+	std::cout << std::endl << std::endl;
+
+	auto odd_it = std::find_if(std::cbegin(*snap), std::cend(*snap), [](int n) {return (n % 2 == 1); });
+	if (odd_it != std::cend(*snap))
+		std::cout << "First odd element is : " << *odd_it << std::endl;
+}
+
+void snapshot_vector_benchmark(unsigned readers = 4, int duration_ms = 1000)
+{
+	// the data is all even except the last element, so every find_if scans the whole vector
+	std::vector<int> data(4096, 2);
+	data.back() = 1;
+
+	snapshot_vector<int> snap_vec(data);
+	std::vector<int> locked_vec(data);
+	std::shared_mutex vec_mutex;
+
+	auto run = [&](auto reader_body, auto writer_body) {
+		std::atomic<bool> stop{ false };
+		std::atomic<std::uint64_t> reads{ 0 };
+		std::vector<std::thread> threads;
+		for (unsigned r = 0; r < readers; ++r)
+			threads.emplace_back([&] {
+				std::uint64_t local{ 0 };
+				while (!stop.load(std::memory_order_relaxed)) {
+					reader_body();
+					++local;
+				}
+				reads += local;
+			});
+		threads.emplace_back([&] {
+			int i{ 0 };
+			while (!stop.load(std::memory_order_relaxed)) {
+				writer_body(i++);
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+		stop = true;
+		for (auto& t : threads)
+			t.join();
+		return reads.load() * 1000.0 / duration_ms;
+	};
+
+	std::atomic<int> found{ 0 };
+	double shared_mutex_rate = run(
+		[&] {
+			std::shared_lock<std::shared_mutex> lock(vec_mutex);
+			found += *std::find_if(std::cbegin(locked_vec), std::cend(locked_vec), [](int n) {return (n % 2 == 1); });
+		},
+		[&](int i) {
+			std::unique_lock<std::shared_mutex> lock(vec_mutex);
+			locked_vec[i % (locked_vec.size() - 1)] = 2 * i;	// stays even
+		});
+
+	double snapshot_rate = run(
+		[&] {
+			auto snap = snap_vec.read();
+			found += *std::find_if(std::cbegin(*snap), std::cend(*snap), [](int n) {return (n % 2 == 1); });
+		},
+		[&](int i) {
+			snap_vec.update([i](std::vector<int>& v) { v[i % (v.size() - 1)] = 2 * i; });
+		});
+
+	std::cout << "\n" << readers << " reader threads doing find_if() over " << data.size() << " ints, one writer updating every 100us\n"
+		<< "  std::shared_mutex : " << shared_mutex_rate << " reads/s\n"
+		<< "  snapshot_vector   : " << snapshot_rate << " reads/s (" << snap_vec.pending_reclaim() << " versions waiting to be freed)\n";
+}
+
+
+//Practical lambda implementation demo
+
+//case insensitive string comparison
+//		Suppose we wrote a function that compares two string arguments and ignores case
+// 
+//				- bool equal_strings(std::string_view lhs, std::string_view rhs);
+//					if(equal_strings(str1,str2))....
+// 
+//		We will rework this using a lambda function
+//		We will use the equal()
+// 
+// equal() ALGORITHM: 
+// equal() used to compare elements in two containers
+//		bool cmp = std::equal(std::cbegin(ct1),std::cend(ct1),std::cbegin(ctd2),std::cend(ct2));
+// 
+// this iterates through each element in container 1, and compares it to the coresponding element in container 2
+// it returns a false as soon as it encounters a mismatch
+//		- if ct1 has more elements than ct2, it will always return false
+//		- if ct2 has more elements than ct1, the extra elements are ignored
+// 
+// By default, the == operator is used to compare the elements
+//		- if the containers are std::string, the comparison will be CASE SENSITIVE	
 // 
 // equal() ALGORITHM WITH PREDICATE:
 // 
@@ -414,15 +1947,18 @@ void is_ODD_Lambda()
 // Then it will convert both characters to upper case.  It will return true if the converted characters are equal,
 // otherwise it will return false.
 // 
-// [] (char lc, char rc){return toupper(lc) == toupper(rc);}
+// [] (char lc, char rc){return toupper(static_cast<unsigned char>(lc)) == toupper(static_cast<unsigned char>(rc));}
+// 
+// toupper() only accepts values which fit in an unsigned char (or EOF). A plain char from UTF-8 or Latin-1 text
+// can be negative, which is undefined behaviour (the debug CRT asserts), hence the casts
 //
 
 //define the predicate
-bool equal_strings(const std::string& lhs, const std::string& rhs) {
+bool equal_strings(std::string_view lhs, std::string_view rhs) {
 	
 	//call equal() algorithm  function using a lambda expression
-	return equal(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs), std::cend(rhs),
-		[](char lc, char rc) {return toupper(lc) == toupper(rc); }
+	return std::equal(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs), std::cend(rhs),
+		[](char lc, char rc) {return toupper(static_cast<unsigned char>(lc)) == toupper(static_cast<unsigned char>(rc)); }
 	);
 
 }
@@ -435,6 +1971,154 @@ void equal_strings_test(const std::string& str1, const std::string& str2)
 		<< " equal" << std::endl;
 }
 
+// 
+// CASE INSENSITIVE SORTING WITH COLLATION KEYS
+// 
+// We could sort case insensitively by giving std::sort() a comparator that calls toupper() on both
+// strings, like equal_strings() does. But every string takes part in about log2(n) comparisons, so
+// every string gets folded to upper case log2(n) times
+// 
+// Collation keys do the folding ONCE:
+//		- every string is folded into one shared buffer (an "arena"), no allocation per string
+//		- the first 8 folded bytes are packed big endian into a std::uint64_t, so comparing two
+//		  prefixes is a single integer compare, and most comparisons are decided there
+//		- only when the prefixes are equal do we memcmp() the rest of the folded bytes
+//		- we sort small fixed size keys (prefix, offset, length, index) instead of the strings,
+//		  and the index breaks ties, so the order is stable
+// 
+// case_insensitive_order() returns the sorted indices, sort_case_insensitive() reorders a vector with them
+//
+
+class collation_keys {
+private:
+	struct key {
+		std::uint64_t prefix;
+		std::uint64_t offset;										// into folded, which can pass 4 GB; the key is 24 bytes either way
+		std::uint32_t length;
+		std::uint32_t index;										// position in the input
+	};
+
+	std::vector<char> folded;
+	std::vector<key> keys;
+
+	bool less(const key& lhs, const key& rhs) const {
+		if (lhs.prefix != rhs.prefix)
+			return lhs.prefix < rhs.prefix;
+		if (lhs.length > 8 && rhs.length > 8) {
+			auto n = std::min(lhs.length, rhs.length) - 8;
+			int cmp = std::memcmp(folded.data() + lhs.offset + 8, folded.data() + rhs.offset + 8, n);
+			if (cmp != 0)
+				return cmp < 0;
+		}
+		if (lhs.length != rhs.length)
+			return lhs.length < rhs.length;
+		return lhs.index < rhs.index;
+	}
+
+public:
+	template<typename Range>
+	explicit collation_keys(const Range& names) {
+		constexpr std::size_t max_u32 = std::numeric_limits<std::uint32_t>::max();
+		if (std::size(names) > max_u32)
+			throw std::length_error("collation_keys: more than 4G names");
+		std::size_t total{ 0 };
+		for (const auto& name : names) {
+			auto size = std::string_view(name).size();
+			if (size > max_u32)
+				throw std::length_error("collation_keys: a name longer than 4 GB");
+			total += size;
+		}
+		folded.resize(total);
+		keys.reserve(std::size(names));
+
+		std::uint64_t offset{ 0 };
+		std::uint32_t index{ 0 };
+		for (const auto& name : names) {
+			std::string_view sv(name);
+			std::uint64_t prefix{ 0 };
+			for (std::size_t i = 0; i < sv.size(); ++i) {
+				auto c = static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(sv[i])));
+				folded[offset + i] = static_cast<char>(c);
+				if (i < 8)
+					prefix |= std::uint64_t{ c } << (56 - 8 * i);	// big endian: the first byte is the most significant
+			}
+			keys.push_back({ prefix, offset, static_cast<std::uint32_t>(sv.size()), index++ });
+			offset += sv.size();
+		}
+	}
+
+	std::vector<std::uint32_t> sorted_indices() {
+		std::sort(std::begin(keys), std::end(keys), [this](const key& lhs, const key& rhs) {return less(lhs, rhs); });
+		std::vector<std::uint32_t> order;
+		order.reserve(keys.size());
+		for (const auto& k : keys)
+			order.push_back(k.index);
+		return order;
+	}
+};
+
+template<typename Range>
+std::vector<std::uint32_t> case_insensitive_order(const Range& names)
+{
+	return collation_keys(names).sorted_indices();
+}
+
+template<typename T>
+void sort_case_insensitive(std::vector<T>& names)
+{
+	auto order = case_insensitive_order(names);
+	std::vector<T> sorted;
+	sorted.reserve(names.size());
+	for (auto i : order)
+		sorted.push_back(std::move(names[i]));
+	names.swap(sorted);
+}
+
+// the comparator version, folding inside every comparison
+bool less_ignore_case(std::string_view lhs, std::string_view rhs)
+{
+	return std::lexicographical_compare(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs), std::cend(rhs),
+		[](char lc, char rc) {return toupper(static_cast<unsigned char>(lc)) < toupper(static_cast<unsigned char>(rc)); });
+}
+
+void case_insensitive_sort_Example()
+{
+	std::vector<std::string> names = { "william", "Benjamin", "nick", "Stan", "finguy", "Vassili", "Nick", "benjamin" };
+
+	std::cout << "\nVector before sort(): ";
+	for (const auto& name : names)
+		std::cout << name << ", ";
+
+	sort_case_insensitive(names);
+
+	std::cout << "\nsorted ignoring case: ";
+	for (const auto& name : names)
+		std::cout << name << ", ";
+	std::cout << std::endl;
+}
+
+void case_insensitive_sort_benchmark(std::size_t n = 10000000)
+{
+	std::mt19937 rng(5);
+	const char* stems[] = { "william", "Benjamin", "NICK", "Stan", "finguy", "Vassili", "Priscilla", "rebecca-jane" };
+	std::vector<std::string> names(n);
+	for (auto& name : names) {
+		name = stems[rng() % 8];
+		name += std::to_string(rng() % 100000);
+		for (auto& ch : name)
+			if (rng() % 4 == 0)
+				ch = static_cast<char>(std::isupper(static_cast<unsigned char>(ch)) ? std::tolower(static_cast<unsigned char>(ch)) : std::toupper(static_cast<unsigned char>(ch)));
+	}
+
+	auto a = names, b = names;
+	double t_comparator = elapsed_ms([&] { std::stable_sort(std::begin(a), std::end(a), less_ignore_case); });
+	double t_keys = elapsed_ms([&] { sort_case_insensitive(b); });
+
+	std::cout << "\ncase insensitive sort of " << n << " strings\n"
+		<< "  std::stable_sort + folding comparator : " << t_comparator << " ms\n"
+		<< "  collation keys                        : " << t_keys << " ms" << (a == b ? "" : " MISMATCH") << "\n";
+}
+
 
 
 
@@ -473,7 +2157,7 @@ void Capture_example()
 
 	std::cout << "Vector before sort(): ";
 
-	for (auto name : words)
+	for (const auto& name : words)
 		std::cout << "\"" << name << "\", ";
 	std::cout << std::endl << std::endl;
 
@@ -511,7 +2195,7 @@ void find_index_example()
 
 	std::cout << "Vector before sort(): ";
 
-	for (auto name : words)
+	for (const auto& name : words)
 		std::cout << "\"" << name << "\", ";
 	std::cout << std::endl << std::endl;
 
@@ -553,7 +2237,7 @@ void find_index_example_with_referenced_lambda_variable()
 
 	std::cout << "Vector before sort(): ";
 
-	for (auto name : words)
+	for (const auto& name : words)
 		std::cout << "\"" << name << "\", ";
 	std::cout << std::endl << std::endl;
 
@@ -636,18 +2320,396 @@ public:
 };
 
 
-//------------------------------------------------------------------------------------------------------//
+//------------------------------------------------------------------------------------------------------//
+
+// 
+// in c++ 17 we also have [*this], this will capture the object by value
+// if we implement this in the class above it will give an error about
+// needing a modifiable value unless we add mutable after the lambda
+// and round brackets and before the curly braces
+// 
+// When we call the member function under that circumstance, the 
+// member function has a copy of the object and it modifies the copy but not the actual object
+// 
+// 
+
+// ------------------------------------------------------------------------------//
+// PASSING PREDICATE ARGUMENTS BY REFERENCE
+// 
+// An algorithm calls the predicate once for every element it visits
+//		- if the predicate takes a std::string BY VALUE, every call makes a copy of the string
+//		- for long strings that copy allocates memory, and it costs far more than the comparison itself
+//		- taking the argument by const& (or as a std::string_view) avoids the copy
+// 
+// callable_traits<> pulls the parameter types out of a function, a function pointer, a functor
+// or a (non generic) lambda, so we can check at compile time whether any "heavyweight" argument
+// is taken by value
+// 
+//		heavyweight = not trivially copyable, or bigger than two pointers
+//
+
+template<typename T>
+struct is_heavyweight_by_value : std::bool_constant<
+	!std::is_reference_v<T> &&
+	(!std::is_trivially_copyable_v<std::decay_t<T>> || (sizeof(std::decay_t<T>) > 2 * sizeof(void*)))> {};
+
+template<typename F>
+struct callable_traits : callable_traits<decltype(&F::operator())> {};						//functors and lambdas: look at operator()
+
+template<typename R, typename... Args>
+struct callable_traits<R(*)(Args...)> {
+	using result_type = R;
+	using arg_types = std::tuple<Args...>;
+	static constexpr bool has_heavy_by_value_param = (is_heavyweight_by_value<Args>::value || ...);
+};
+
+template<typename R, typename... Args>
+struct callable_traits<R(Args...)> : callable_traits<R(*)(Args...)> {};
+
+template<typename C, typename R, typename... Args>
+struct callable_traits<R(C::*)(Args...)> : callable_traits<R(*)(Args...)> {};
+
+template<typename C, typename R, typename... Args>
+struct callable_traits<R(C::*)(Args...) const> : callable_traits<R(*)(Args...)> {};
+
+template<typename F>
+inline constexpr bool has_heavy_by_value_param_v = callable_traits<std::remove_cv_t<std::remove_reference_t<F>>>::has_heavy_by_value_param;
+
+// checked_predicate() passes the predicate straight through, but refuses to compile
+// if the predicate would copy a heavyweight argument on every call
+//
+//		std::find_if(cbegin(words), cend(words), checked_predicate(is_longer_than));
+//
+template<typename Pred>
+Pred checked_predicate(Pred pred)
+{
+	static_assert(!has_heavy_by_value_param_v<Pred>,
+		"predicate takes a heavyweight argument by value, take it by const& or std::string_view");
+	return pred;
+}
+
+// view_predicate lets a predicate written for std::string_view be used on a container of std::string
+// the element is forwarded as a view, so nothing is copied however the predicate is written
+//
+//		auto longer = view_predicate([](std::string_view sv) {return sv.size() > 5; });
+//
+template<typename Pred>
+class view_predicate {
+private:
+	Pred pred;
+public:
+	explicit view_predicate(Pred pred) : pred(std::move(pred)) {}
+
+	template<typename... Strs>
+	bool operator() (const Strs&... strs) const {
+		return pred(std::string_view(strs)...);
+	}
+};
+
+// Audit of the predicates in this file: none of them should copy a string per call
+static_assert(!has_heavy_by_value_param_v<decltype(is_shorter)>, "is_shorter copies its arguments");
+static_assert(!has_heavy_by_value_param_v<is_shorter_2>, "is_shorter_2 copies its arguments");
+static_assert(!has_heavy_by_value_param_v<greater_than_5>, "greater_than_5 copies its argument");
+static_assert(!has_heavy_by_value_param_v<ge_n>, "ge_n copies its argument");
+static_assert(!has_heavy_by_value_param_v<is_odd>, "is_odd copies its argument");
+static_assert(!has_heavy_by_value_param_v<decltype(&equal_strings)>, "equal_strings copies its arguments");
+
+// ...and the check really does catch a string taken by value
+static_assert(has_heavy_by_value_param_v<bool(*)(const std::string)>, "by-value std::string should be flagged");
+
+// How much does the copy actually cost?
+// find_if() over strings which never match, so every element is passed to the predicate
+void predicate_copy_cost_benchmark()
+{
+	std::vector<std::string> words(200000, std::string(256, 'x'));
+	const std::size_t max{ 1000 };
+	std::vector<std::string>::const_iterator res;
+
+	auto by_value = [max](const std::string str) {return str.size() > max; };
+	auto by_ref = [max](const std::string& str) {return str.size() > max; };
+	auto by_view = view_predicate([max](std::string_view sv) {return sv.size() > max; });
+
+	static_assert(has_heavy_by_value_param_v<decltype(by_value)>, "by_value is the slow version on purpose");
+
+	std::cout << "\nfind_if() over " << words.size() << " strings of " << words[0].size() << " characters\n";
+
+	double t1 = elapsed_ms([&] { res = std::find_if(std::cbegin(words), std::cend(words), by_value); });
+	std::cout << "predicate takes const std::string    : " << t1 << " ms" << (res == std::cend(words) ? "" : " (found)") << "\n";
+
+	double t2 = elapsed_ms([&] { res = std::find_if(std::cbegin(words), std::cend(words), checked_predicate(by_ref)); });
+	std::cout << "predicate takes const std::string&   : " << t2 << " ms" << (res == std::cend(words) ? "" : " (found)") << "\n";
+
+	double t3 = elapsed_ms([&] { res = std::find_if(std::cbegin(words), std::cend(words), by_view); });
+	std::cout << "predicate takes std::string_view     : " << t3 << " ms" << (res == std::cend(words) ? "" : " (found)") << "\n";
+}
+
+// ------------------------------------------------------------------------------//
+// LOADING NAMES STRAIGHT FROM A MAPPED FILE
+// 
+// The examples above use short hard coded lists, real inputs are newline separated files
+// which can be several GB
+// 
+// Reading them with std::getline() into a std::vector<std::string> copies every line
+// (and allocates for every line longer than the small string buffer)
+// 
+// name_corpus maps the file into memory instead and builds a table of std::string_view,
+// one per line, which point straight into the mapped bytes
+//		- nothing is copied, the OS pages the file in as it is touched
+//		- newlines are found 16 bytes at a time with SSE2 when it is available (memchr otherwise)
+//		- with threads > 1 the file is split into chunks which are indexed in parallel
+// 
+// The views stay valid as long as the name_corpus object is alive
+// 
+// is_shorter, is_shorter_2, greater_than_5, ge_n and equal_strings take std::string_view,
+// so they work on the mapped lines without any changes
+//
+
+class mapped_file {
+private:
+	const char* ptr{ nullptr };
+	std::size_t len{ 0 };
+#ifdef _WIN32
+	HANDLE file{ INVALID_HANDLE_VALUE };
+	HANDLE mapping{ nullptr };
+#endif
+
+	void close() {
+#ifdef _WIN32
+		if (ptr) UnmapViewOfFile(ptr);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		file = INVALID_HANDLE_VALUE;
+		mapping = nullptr;
+#else
+		if (ptr) munmap(const_cast<char*>(ptr), len);
+#endif
+		ptr = nullptr;
+		len = 0;
+	}
+
+public:
+	mapped_file() = default;
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator= (const mapped_file&) = delete;
+	~mapped_file() { close(); }
+
+	// returns false if the file could not be opened or mapped
+	bool open(const std::string& path) {
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+			return false;
+		len = static_cast<std::size_t>(size.QuadPart);
+		if (len == 0)
+			return true;
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+			return false;
+		ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		return ptr != nullptr;
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			::close(fd);
+			return false;
+		}
+		len = static_cast<std::size_t>(st.st_size);
+		if (len == 0) {
+			::close(fd);
+			return true;
+		}
+		void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);												// the mapping keeps the file alive
+		if (p == MAP_FAILED) {
+			len = 0;
+			return false;
+		}
+		madvise(p, len, MADV_SEQUENTIAL);
+		ptr = static_cast<const char*>(p);
+		return true;
+#endif
+	}
+
+	const char* data() const { return ptr; }
+	std::size_t size() const { return len; }
+};
+
+// append a view for every line in [begin, end), begin must be the start of a line
+// a '\r' before the '\n' is dropped, and so is the empty "line" after a final '\n'
+inline void index_lines(const char* begin, const char* end, std::vector<std::string_view>& lines)
+{
+	auto add_line = [&lines](const char* first, const char* last) {
+		if (last != first && last[-1] == '\r')
+			--last;
+		lines.emplace_back(first, static_cast<std::size_t>(last - first));
+	};
+
+	const char* line = begin;
+	const char* p = begin;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	const __m128i newline = _mm_set1_epi8('\n');
+	for (; end - p >= 16; p += 16) {
+		auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+			_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), newline)));
+		while (mask) {
+			const char* nl = p + std::countr_zero(mask);
+			add_line(line, nl);
+			line = nl + 1;
+			mask &= mask - 1;									// clear the lowest set bit
+		}
+	}
+#endif
+	while (p < end) {
+		auto nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+		if (!nl)
+			break;
+		add_line(line, nl);
+		line = p = nl + 1;
+	}
+	if (line < end)
+		add_line(line, end);
+}
+
+class name_corpus {
+private:
+	mapped_file file;
+	std::vector<std::string_view> lines;
+
+public:
+	bool load(const std::string& path, unsigned threads = 1) {
+		lines.clear();
+		if (!file.open(path))
+			return false;
+
+		const char* begin = file.data();
+		const char* end = begin + file.size();
+		if (threads <= 1 || file.size() < (1u << 20)) {
+			index_lines(begin, end, lines);
+			return true;
+		}
+
+		// chunk boundaries are moved forward to just after a newline, so every chunk starts on a line
+		std::vector<const char*> bounds{ begin };
+		for (unsigned t = 1; t < threads; ++t) {
+			const char* nominal = begin + file.size() / threads * t;
+			nominal = std::max(nominal, bounds.back());
+			auto nl = static_cast<const char*>(std::memchr(nominal, '\n', static_cast<std::size_t>(end - nominal)));
+			bounds.push_back(nl ? nl + 1 : end);
+		}
+		bounds.push_back(end);
+
+		std::vector<std::vector<std::string_view>> parts(threads);
+		std::vector<std::thread> workers;
+		for (unsigned t = 0; t < threads; ++t)
+			workers.emplace_back([&, t] { index_lines(bounds[t], bounds[t + 1], parts[t]); });
+		for (auto& w : workers)
+			w.join();
+
+		std::size_t total{ 0 };
+		for (const auto& part : parts)
+			total += part.size();
+		lines.reserve(total);
+		for (const auto& part : parts)
+			lines.insert(std::end(lines), std::cbegin(part), std::cend(part));
+		return true;
+	}
+
+	std::vector<std::string_view>& names() { return lines; }
+	const std::vector<std::string_view>& names() const { return lines; }
+	std::size_t size() const { return lines.size(); }
+	std::size_t bytes() const { return file.size(); }
+};
+
+// sorting(), _if_Finder(), Capture_example() and equal_strings() over a mapped file
+void mapped_corpus_Example(const std::string& path)
+{
+	name_corpus corpus;
+	if (!corpus.load(path, std::max(1u, std::thread::hardware_concurrency()))) {
+		std::cout << "could not map \"" << path << "\"\n";
+		return;
+	}
+	auto& names = corpus.names();
+	std::cout << "\nmapped " << corpus.bytes() << " bytes, " << names.size() << " names\n";
+	if (names.empty())
+		return;
+
+	// sorting(): the views are sorted, the file itself is read only and never moves
+	std::sort(std::begin(names), std::end(names));
+	std::cout << "alphabetically first: \"" << names.front() << "\", last: \"" << names.back() << "\"\n";
+	std::stable_sort(std::begin(names), std::end(names), is_shorter);
+	std::cout << "shortest: \"" << names.front() << "\", longest: \"" << names.back() << "\"\n";
 
-// 
-// in c++ 17 we also have [*this], this will capture the object by value
-// if we implement this in the class above it will give an error about
-// needing a modifiable value unless we add mutable after the lambda
-// and round brackets and before the curly braces
-// 
-// When we call the member function under that circumstance, the 
-// member function has a copy of the object and it modifies the copy but not the actual object
-// 
-// 
+	// _if_Finder()
+	auto res = std::find_if(std::cbegin(names), std::cend(names), greater_than_5());
+	if (res != std::cend(names))
+		std::cout << "the first name with > 5 characters is \"" << *res << "\"\n";
+	auto res3 = std::find_if(std::cbegin(names), std::cend(names), ge_n(8));
+	if (res3 != std::cend(names))
+		std::cout << "the first name with > 8 characters is \"" << *res3 << "\"\n";
+
+	// Capture_example()
+	std::size_t n{ 10 };
+	auto res4 = std::find_if(std::cbegin(names), std::cend(names), [n](std::string_view str) {return str.size() > n; });
+	if (res4 != std::cend(names))
+		std::cout << "the first name which is more than " << n << " letters long is \"" << *res4 << "\"\n";
+
+	// equal_strings()
+	auto dup = std::adjacent_find(std::cbegin(names), std::cend(names), equal_strings);
+	if (dup != std::cend(names))
+		std::cout << "\"" << dup[0] << "\" and \"" << dup[1] << "\" are equal ignoring case\n";
+}
+
+// writes a test file of generated names, then loads it with std::getline() and with name_corpus
+void corpus_load_benchmark(std::size_t lines = 10000000)
+{
+	const std::string path{ "corpus_load_benchmark.txt" };
+	{
+		const char* stems[] = { "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili", "Rebecca-Jane", "Nataliana" };
+		std::ofstream out(path, std::ios::binary);
+		for (std::size_t i = 0; i < lines; ++i)
+			out << stems[i % 8] << '_' << i << '\n';
+	}
+
+	std::size_t count_getline{ 0 }, count_view{ 0 }, count_parallel{ 0 };
+	double t_getline = elapsed_ms([&] {
+		std::ifstream in(path, std::ios::binary);
+		std::vector<std::string> names;
+		std::string line;
+		while (std::getline(in, line))
+			names.push_back(line);
+		count_getline = names.size();
+	});
+
+	double t_view = elapsed_ms([&] {
+		name_corpus corpus;
+		corpus.load(path);
+		count_view = corpus.size();
+	});
+
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	double t_parallel = elapsed_ms([&] {
+		name_corpus corpus;
+		corpus.load(path, threads);
+		count_parallel = corpus.size();
+	});
+
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	double mb = static_cast<double>(in.tellg()) / (1024.0 * 1024.0);
+	in.close();
+	std::remove(path.c_str());
+
+	std::cout << "\nloading " << lines << " names (" << mb << " MB)\n"
+		<< "std::getline into std::vector<std::string> : " << t_getline << " ms, " << mb / t_getline * 1000.0 << " MB/s (" << count_getline << " lines)\n"
+		<< "name_corpus, 1 thread                      : " << t_view << " ms, " << mb / t_view * 1000.0 << " MB/s (" << count_view << " lines)\n"
+		<< "name_corpus, " << threads << " threads                     : " << t_parallel << " ms, " << mb / t_parallel * 1000.0 << " MB/s (" << count_parallel << " lines)\n";
+}
 
 // ------------------------------------------------------------------------------//
 // LAMBDA EXPRESSIONS AND PARTIAL EVALUATION
@@ -673,7 +2735,7 @@ void Storing_Lambdas() {
 
 	std::cout << "Vector words: ";
 
-	for (auto name : words)
+	for (const auto& name : words)
 		std::cout << "\"" << name << "\", ";
 	std::cout << std::endl << std::endl;
 	int max{ 5 };
@@ -682,7 +2744,9 @@ void Storing_Lambdas() {
 
 
 	//Save the lambda expression in a variable
-	auto is_longer_than = [max](const std::string str) {return str.size() > max; };
+	auto is_longer_than = [max](const std::string& str) {return str.size() > max; };		//take the string by const&, or every find_if step copies it
+
+	static_assert(!has_heavy_by_value_param_v<decltype(is_longer_than)>, "is_longer_than should not copy its argument");
 
 	//Pass the variable as the predicate
 	auto res = std::find_if(std::cbegin(words), std::cend(words), is_longer_than);
@@ -802,6 +2866,238 @@ void Pairs_example() {
 }
 
 
+
+// 
+// COMPACT STORAGE FOR LOTS OF STRING PAIRS
+// 
+// std::pair<std::string, std::string> is 64 bytes (two 32 byte strings) before either string
+// allocates anything, and any string longer than the small string buffer also has its own heap block
+// 
+// When we keep millions of key/value pairs, and the keys repeat a lot, we can do much better:
+//		- intern the keys: every distinct key is stored once and each pair only holds a 4 byte key id
+//		- pack the values into 8 bytes: up to 7 characters are stored inline (like the small string
+//		  optimisation), longer ones are a 40 bit offset + 23 bit length into one shared character buffer
+//		  (1 TB of value characters, values up to 8 MB; anything bigger throws std::length_error)
+//		- struct of arrays: the key ids and the values live in two separate vectors, so a scan over
+//		  the keys does not drag the values through the cache
+// 
+// sort_by_first() ranks the distinct keys once and then does a counting sort on the ranks,
+// after that find_first() is a hash lookup plus an O(1) bucket range
+// find_first() sorts the table itself when pairs were added since the last sort, so pair indices
+// from before an add() are not kept
+//
+
+class compact_pair_table {
+private:
+	struct packed_value {
+		static constexpr unsigned char long_marker = 0x80;		// set in bytes[7] for long values, short lengths are 0 to 7
+		static constexpr std::uint64_t max_offset = (std::uint64_t{ 1 } << 40) - 1;
+		static constexpr std::uint32_t max_length = (std::uint32_t{ 1 } << 23) - 1;
+		char bytes[8];											// short: chars + length in bytes[7], long: offset(5) + length(2) + marker | length >> 16
+	};
+
+	std::deque<std::string> key_pool;							// deque never moves its elements, so the views in key_index stay valid
+	std::unordered_map<std::string_view, std::uint32_t> key_index;
+	std::vector<std::uint32_t> firsts;							// key id of every pair
+	std::vector<packed_value> seconds;							// value of every pair
+	std::vector<char> value_chars;								// storage for values which do not fit inline
+
+	std::vector<std::uint32_t> bucket_start;					// after sort_by_first(): pairs with key rank r are [bucket_start[r], bucket_start[r+1])
+	std::vector<std::uint32_t> key_rank;						// key id -> position of the key in alphabetical order
+	bool sorted{ false };
+
+	std::uint32_t intern(std::string_view key) {
+		auto it = key_index.find(key);
+		if (it != key_index.end())
+			return it->second;
+		auto id = static_cast<std::uint32_t>(key_pool.size());
+		key_pool.emplace_back(key);
+		key_index.emplace(key_pool.back(), id);
+		return id;
+	}
+
+	packed_value pack(std::string_view value) {
+		packed_value pv{};
+		if (value.size() < sizeof(pv.bytes)) {
+			std::memcpy(pv.bytes, value.data(), value.size());
+			pv.bytes[7] = static_cast<char>(value.size());
+		}
+		else {
+			if (value.size() > packed_value::max_length)
+				throw std::length_error("compact_pair_table: value longer than 8 MB");
+			if (value_chars.size() + value.size() > packed_value::max_offset)
+				throw std::length_error("compact_pair_table: more than 1 TB of value characters");
+			auto offset = static_cast<std::uint64_t>(value_chars.size());
+			auto length = static_cast<std::uint32_t>(value.size());
+			value_chars.insert(value_chars.end(), value.begin(), value.end());
+			for (int b = 0; b < 5; ++b)
+				pv.bytes[b] = static_cast<char>(offset >> (8 * b));
+			pv.bytes[5] = static_cast<char>(length);
+			pv.bytes[6] = static_cast<char>(length >> 8);
+			pv.bytes[7] = static_cast<char>(packed_value::long_marker | (length >> 16));
+		}
+		return pv;
+	}
+
+public:
+	void reserve(std::size_t n) {
+		firsts.reserve(n);
+		seconds.reserve(n);
+	}
+
+	void add(std::string_view first, std::string_view second) {
+		if (firsts.size() == std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error("compact_pair_table: more than 4G pairs");	// bucket_start holds 32 bit positions
+		firsts.push_back(intern(first));
+		seconds.push_back(pack(second));
+		sorted = false;
+	}
+
+	std::size_t size() const { return firsts.size(); }
+	std::size_t distinct_keys() const { return key_pool.size(); }
+
+	std::string_view first(std::size_t i) const { return key_pool[firsts[i]]; }
+
+	std::string_view second(std::size_t i) const {
+		const packed_value& pv = seconds[i];
+		auto tag = static_cast<unsigned char>(pv.bytes[7]);
+		if (!(tag & packed_value::long_marker))
+			return std::string_view(pv.bytes, tag);
+		std::uint64_t offset{ 0 };
+		for (int b = 0; b < 5; ++b)
+			offset |= std::uint64_t{ static_cast<unsigned char>(pv.bytes[b]) } << (8 * b);
+		std::uint32_t length = static_cast<unsigned char>(pv.bytes[5])
+			| (std::uint32_t{ static_cast<unsigned char>(pv.bytes[6]) } << 8)
+			| (std::uint32_t{ tag & ~packed_value::long_marker & 0xFFu } << 16);
+		return std::string_view(value_chars.data() + offset, length);
+	}
+
+	// stable sort by first: pairs with equal keys keep the order they were added in
+	void sort_by_first() {
+		std::vector<std::uint32_t> by_name(key_pool.size());
+		std::iota(std::begin(by_name), std::end(by_name), 0u);
+		std::sort(std::begin(by_name), std::end(by_name),
+			[this](std::uint32_t lhs, std::uint32_t rhs) {return key_pool[lhs] < key_pool[rhs]; });
+
+		key_rank.assign(key_pool.size(), 0);
+		for (std::uint32_t r = 0; r < by_name.size(); ++r)
+			key_rank[by_name[r]] = r;
+
+		// counting sort on the key ranks
+		bucket_start.assign(key_pool.size() + 1, 0);
+		for (auto id : firsts)
+			++bucket_start[key_rank[id] + 1];
+		std::partial_sum(std::begin(bucket_start), std::end(bucket_start), std::begin(bucket_start));
+
+		std::vector<std::uint32_t> next(std::begin(bucket_start), std::end(bucket_start) - 1);
+		std::vector<std::uint32_t> new_firsts(firsts.size());
+		std::vector<packed_value> new_seconds(seconds.size());
+		for (std::size_t i = 0; i < firsts.size(); ++i) {
+			auto pos = next[key_rank[firsts[i]]]++;
+			new_firsts[pos] = firsts[i];
+			new_seconds[pos] = seconds[i];
+		}
+		firsts.swap(new_firsts);
+		seconds.swap(new_seconds);
+		sorted = true;
+	}
+
+	// returns the index range [first, last) of all the pairs whose first member is key
+	// sorts the table first if anything was added since the last sort_by_first(), then O(1)
+	std::pair<std::size_t, std::size_t> find_first(std::string_view key) {
+		auto it = key_index.find(key);
+		if (it == key_index.end())
+			return { size(), size() };
+
+		if (!sorted)
+			sort_by_first();
+		auto r = key_rank[it->second];
+		return { bucket_start[r], bucket_start[r + 1] };
+	}
+
+	// approximate heap footprint, including the hash table nodes for the interned keys
+	std::size_t memory_bytes() const {
+		std::size_t bytes = firsts.capacity() * sizeof(std::uint32_t)
+			+ seconds.capacity() * sizeof(packed_value)
+			+ value_chars.capacity()
+			+ (bucket_start.capacity() + key_rank.capacity()) * sizeof(std::uint32_t);
+		for (const auto& key : key_pool)
+			bytes += sizeof(std::string) + (key.capacity() > 15 ? key.capacity() + 1 : 0);
+		bytes += key_index.bucket_count() * sizeof(void*)
+			+ key_index.size() * (sizeof(std::pair<const std::string_view, std::uint32_t>) + 2 * sizeof(void*));
+		return bytes;
+	}
+};
+
+// heap footprint of the plain version, for comparison
+std::size_t pair_vector_memory_bytes(const std::vector<std::pair<std::string, std::string>>& pairs)
+{
+	std::size_t bytes = pairs.capacity() * sizeof(std::pair<std::string, std::string>);
+	for (const auto& p : pairs) {
+		bytes += p.first.capacity() > 15 ? p.first.capacity() + 1 : 0;
+		bytes += p.second.capacity() > 15 ? p.second.capacity() + 1 : 0;
+	}
+	return bytes;
+}
+
+void compact_pair_table_benchmark()
+{
+	const std::size_t n{ 1000000 }, distinct{ 5000 }, lookups{ 1000000 };
+
+	std::vector<std::pair<std::string, std::string>> pairs;
+	compact_pair_table table;
+	pairs.reserve(n);
+	table.reserve(n);
+
+	for (std::size_t i = 0; i < n; ++i) {
+		std::string key = "customer_account_" + std::to_string((i * 7919) % distinct);
+		std::string value = (i % 3 == 0) ? std::to_string(i % 1000) : "order_reference_" + std::to_string(i);
+		table.add(key, value);
+		pairs.emplace_back(std::move(key), std::move(value));
+	}
+
+	std::cout << "\n" << n << " pairs, " << table.distinct_keys() << " distinct keys\n";
+
+	double t_sort_vec = elapsed_ms([&] {
+		std::stable_sort(std::begin(pairs), std::end(pairs),
+			[](const auto& lhs, const auto& rhs) {return lhs.first < rhs.first; });
+	});
+	double t_sort_table = elapsed_ms([&] { table.sort_by_first(); });
+
+	std::cout << "std::vector<std::pair<std::string,std::string>> : "
+		<< double(pair_vector_memory_bytes(pairs)) / n << " bytes/pair, sort " << t_sort_vec << " ms\n";
+	std::cout << "compact_pair_table                              : "
+		<< double(table.memory_bytes()) / n << " bytes/pair, sort " << t_sort_table << " ms\n";
+
+	std::vector<std::string> queries;
+	for (std::size_t i = 0; i < 1024; ++i)
+		queries.push_back("customer_account_" + std::to_string((i * 31) % distinct));
+
+	std::size_t hits_vec{ 0 }, hits_table{ 0 };
+	double t_find_vec = elapsed_ms([&] {
+		for (std::size_t i = 0; i < lookups; ++i) {
+			const std::string& q = queries[i % queries.size()];
+			auto range = std::equal_range(std::cbegin(pairs), std::cend(pairs), q,
+				[](const auto& lhs, const auto& rhs) {
+					if constexpr (std::is_same_v<std::decay_t<decltype(lhs)>, std::string>)
+						return lhs < rhs.first;
+					else
+						return lhs.first < rhs;
+				});
+			hits_vec += range.second - range.first;
+		}
+	});
+	double t_find_table = elapsed_ms([&] {
+		for (std::size_t i = 0; i < lookups; ++i) {
+			auto range = table.find_first(queries[i % queries.size()]);
+			hits_table += range.second - range.first;
+		}
+	});
+
+	std::cout << "lookup by first, vector + equal_range : " << lookups / t_find_vec / 1000.0 << " M lookups/s (" << hits_vec << " hits)\n";
+	std::cout << "lookup by first, compact_pair_table   : " << lookups / t_find_table / 1000.0 << " M lookups/s (" << hits_table << " hits)\n";
+}
+
 //Insert Iterators
 // 
 // An output stream iterator inserts data into an output stream
@@ -848,40 +3144,733 @@ void back_insert_iterator_Example()
 	*it = 99;																			//calls vec.pushback(99)
 	*it = 88;																			//calls vec.pushback(88)
 
-	//Vector elements are now {99, 88}
-	std::cout << "Vector NOW has " << vec.size() << " elements in it\n";
+	//Vector elements are now {99, 88}
+	std::cout << "Vector NOW has " << vec.size() << " elements in it\n";
+
+	for (auto v : vec)
+		std::cout << v << ", ";
+	std::cout << std::endl;
+
+}
+
+// 
+// BULK BACK INSERTION
+// 
+// std::back_inserter() calls push_back() once per element
+//		- the container does not know how many elements are coming, so a vector grows (reallocates and moves
+//		  everything) about log2(n) times while std::copy() is running
+// 
+// back_sink() returns an output iterator which behaves exactly like the back_insert_iterator, so it can be
+// used with any algorithm, but it also has append() calls which take the whole source range at once
+//		- if the size of the source range is known (forward iterators or a sized range) we reserve() once,
+//		  still at least doubling the capacity, so many small appends stay amortised O(1)
+//		- insert() at the end already copies a contiguous, trivially copyable source with one memmove()
+// 
+// sink_copy() and sink_transform() are the std::copy()/std::transform() equivalents which use this
+//
+
+template<typename Container>
+class back_insert_sink {
+private:
+	Container* container;
+public:
+	using iterator_category = std::output_iterator_tag;
+	using value_type = void;
+	using difference_type = std::ptrdiff_t;
+	using pointer = void;
+	using reference = void;
+	using container_type = Container;
+
+	explicit back_insert_sink(Container& c) : container(&c) {}
+
+	// the ordinary back_insert_iterator interface
+	back_insert_sink& operator= (const typename Container::value_type& value) { container->push_back(value); return *this; }
+	back_insert_sink& operator= (typename Container::value_type&& value) { container->push_back(std::move(value)); return *this; }
+	back_insert_sink& operator* () { return *this; }
+	back_insert_sink& operator++ () { return *this; }
+	back_insert_sink operator++ (int) { return *this; }
+
+	// make room for n more elements, if the container supports it
+	// growing to exactly size() + n on every call would reallocate on every call
+	void reserve_more(std::size_t n) {
+		if constexpr (requires(Container& c) { c.reserve(n); c.capacity(); }) {
+			auto needed = container->size() + n;
+			if (needed > container->capacity())
+				container->reserve(std::max(needed, 2 * container->capacity()));
+		}
+	}
+
+	template<typename InputIt>
+	back_insert_sink& append(InputIt first, InputIt last) {
+		if constexpr (std::forward_iterator<InputIt>) {
+			reserve_more(static_cast<std::size_t>(std::distance(first, last)));
+			container->insert(std::end(*container), first, last);		// memmoves if it can
+		}
+		else {
+			for (; first != last; ++first)								// single pass input, the size is unknown
+				container->push_back(*first);
+		}
+		return *this;
+	}
+
+	template<typename Range>
+	back_insert_sink& append(const Range& range) {
+		return append(std::begin(range), std::end(range));
+	}
+
+	template<typename InputIt, typename UnaryOp>
+	back_insert_sink& append_transformed(InputIt first, InputIt last, UnaryOp op) {
+		if constexpr (std::forward_iterator<InputIt>)
+			reserve_more(static_cast<std::size_t>(std::distance(first, last)));
+		for (; first != last; ++first)
+			container->push_back(op(*first));
+		return *this;
+	}
+};
+
+template<typename Container>
+back_insert_sink<Container> back_sink(Container& c)
+{
+	return back_insert_sink<Container>(c);
+}
+
+template<typename InputIt, typename Container>
+back_insert_sink<Container> sink_copy(InputIt first, InputIt last, back_insert_sink<Container> out)
+{
+	return out.append(first, last);
+}
+
+template<typename InputIt, typename Container, typename UnaryOp>
+back_insert_sink<Container> sink_transform(InputIt first, InputIt last, back_insert_sink<Container> out, UnaryOp op)
+{
+	return out.append_transformed(first, last, op);
+}
+
+void back_inserter_benchmark(std::size_t max_elements = 100000000)
+{
+	std::cout << "\ncopy()/transform() into an empty std::vector<int>\n";
+
+	for (std::size_t n = 1000000; n <= max_elements; n *= 10) {
+		std::vector<int> src(n);
+		std::iota(std::begin(src), std::end(src), 0);
+
+		std::vector<int> a, b, c, d, e;
+		double t_copy = elapsed_ms([&] { std::copy(std::cbegin(src), std::cend(src), std::back_inserter(a)); });
+		double t_reserve = elapsed_ms([&] { b.reserve(n); std::copy(std::cbegin(src), std::cend(src), std::back_inserter(b)); });
+		double t_sink = elapsed_ms([&] { sink_copy(std::cbegin(src), std::cend(src), back_sink(c)); });
+		double t_transform = elapsed_ms([&] { std::transform(std::cbegin(src), std::cend(src), std::back_inserter(d), [](int i) {return i * 2; }); });
+		double t_sink_transform = elapsed_ms([&] { sink_transform(std::cbegin(src), std::cend(src), back_sink(e), [](int i) {return i * 2; }); });
+
+		std::cout << n << " ints:\n"
+			<< "  copy + back_inserter             : " << t_copy << " ms\n"
+			<< "  reserve + copy + back_inserter   : " << t_reserve << " ms\n"
+			<< "  sink_copy + back_sink            : " << t_sink << " ms\n"
+			<< "  transform + back_inserter        : " << t_transform << " ms\n"
+			<< "  sink_transform + back_sink       : " << t_sink_transform << " ms\n";
+
+		if (a != c || d != e)
+			std::cout << "  MISMATCH between back_inserter and back_sink results\n";
+	}
+}
+
+// 
+// MANY THREADS APPENDING TO ONE OUTPUT
+// 
+// std::back_inserter() into a std::vector cannot be shared between threads: push_back() may
+// reallocate and move every element while another thread is writing
+// 
+// concurrent_append_vector is append only and never moves an element once it is written
+//		- storage is a list of segments, each twice the size of the one before, so the segment
+//		  and offset of index i are worked out with a little bit arithmetic
+//		- push_back() and append() reserve their index range with one atomic fetch_add(), then
+//		  write into it, no lock is taken
+//		- a segment is allocated by whichever thread needs it first; if two threads race, one
+//		  compare_exchange wins and the other frees its copy
+//		- compact() copies everything into an ordinary contiguous std::vector, call it once all
+//		  writers are finished
+// 
+// batch_appender is the per-thread back inserter: it collects elements locally and appends
+// them in blocks, so the shared counter is touched once per block instead of once per element
+//		- like batched_insert_sink, the destructor flushes what is left, but a flush can allocate a
+//		  segment and throw: the destructor then drops the batch, and skips it while another exception
+//		  is unwinding the stack. Call flush() yourself when the elements must not be lost
+//
+
+template<typename T, std::size_t FirstSegment = 1024>
+class concurrent_append_vector {
+	static_assert((FirstSegment & (FirstSegment - 1)) == 0, "FirstSegment must be a power of two");
+
+private:
+	static constexpr std::size_t max_segments{ 48 };
+
+	std::array<std::atomic<T*>, max_segments> segments{};
+	std::atomic<std::size_t> reserved{ 0 };
+
+	// index i lives in segment s where FirstSegment * (2^s - 1) <= i < FirstSegment * (2^(s+1) - 1)
+	static std::size_t segment_of(std::size_t i) { return std::bit_width(i / FirstSegment + 1) - 1; }
+	static std::size_t segment_start(std::size_t s) { return FirstSegment * ((std::size_t{ 1 } << s) - 1); }
+	static std::size_t segment_size(std::size_t s) { return FirstSegment << s; }
+
+	T* segment(std::size_t s) {
+		T* seg = segments[s].load(std::memory_order_acquire);
+		if (seg)
+			return seg;
+		T* fresh = std::allocator<T>().allocate(segment_size(s));
+		if (segments[s].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel))
+			return fresh;
+		std::allocator<T>().deallocate(fresh, segment_size(s));		// another thread got there first
+		return seg;
+	}
+
+public:
+	concurrent_append_vector() = default;
+	concurrent_append_vector(const concurrent_append_vector&) = delete;
+	concurrent_append_vector& operator= (const concurrent_append_vector&) = delete;
+
+	~concurrent_append_vector() {
+		std::size_t n = size();
+		for (std::size_t s = 0; s < max_segments; ++s) {
+			T* seg = segments[s].load();
+			if (!seg)
+				continue;
+			std::size_t first = segment_start(s);
+			std::size_t last = std::min(n, first + segment_size(s));
+			if (first < last)
+				std::destroy(seg, seg + (last - first));
+			std::allocator<T>().deallocate(seg, segment_size(s));
+		}
+	}
+
+	void push_back(const T& value) {
+		std::size_t i = reserved.fetch_add(1, std::memory_order_relaxed);
+		std::size_t s = segment_of(i);
+		std::construct_at(segment(s) + (i - segment_start(s)), value);
+	}
+
+	template<typename InputIt>
+	void append(InputIt first, InputIt last) {
+		std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+		std::size_t i = reserved.fetch_add(n, std::memory_order_relaxed);
+		while (first != last) {
+			std::size_t s = segment_of(i);
+			std::size_t offset = i - segment_start(s);
+			std::size_t room = std::min(n, segment_size(s) - offset);	// what fits in this segment
+			std::uninitialized_copy_n(first, room, segment(s) + offset);
+			std::advance(first, room);
+			i += room;
+			n -= room;
+		}
+	}
+
+	// only meaningful once the writers have finished
+	std::size_t size() const { return reserved.load(std::memory_order_acquire); }
+
+	const T& operator[] (std::size_t i) const {
+		std::size_t s = segment_of(i);
+		return segments[s].load(std::memory_order_acquire)[i - segment_start(s)];
+	}
+
+	std::vector<T> compact() const {
+		std::vector<T> res;
+		std::size_t n = size();
+		res.reserve(n);
+		for (std::size_t s = 0; res.size() < n; ++s) {
+			const T* seg = segments[s].load(std::memory_order_acquire);
+			std::size_t count = std::min(n - res.size(), segment_size(s));
+			res.insert(std::end(res), seg, seg + count);
+		}
+		return res;
+	}
+};
+
+// per-thread batching, used like batched_insert_sink: copy(..., appender.out())
+template<typename T, std::size_t FirstSegment>
+class batch_appender {
+private:
+	concurrent_append_vector<T, FirstSegment>& target;
+	std::vector<T> buffer;
+	std::size_t batch;
+	int exceptions_at_start{ std::uncaught_exceptions() };
+
+public:
+	class iterator {
+	private:
+		batch_appender* owner;
+	public:
+		using iterator_category = std::output_iterator_tag;
+		using value_type = void;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = void;
+
+		explicit iterator(batch_appender& a) : owner(&a) {}
+		iterator& operator= (const T& value) { owner->push_back(value); return *this; }
+		iterator& operator* () { return *this; }
+		iterator& operator++ () { return *this; }
+		iterator operator++ (int) { return *this; }
+	};
+
+	explicit batch_appender(concurrent_append_vector<T, FirstSegment>& target, std::size_t batch = 4096)
+		: target(target), batch(batch) {
+		buffer.reserve(batch);
+	}
+
+	batch_appender(const batch_appender&) = delete;
+	batch_appender& operator= (const batch_appender&) = delete;
+
+	~batch_appender() {
+		if (std::uncaught_exceptions() > exceptions_at_start)
+			return;
+		try {
+			flush();
+		}
+		catch (...) {}											// noexcept destructor, see above
+	}
+
+	void push_back(const T& value) {
+		buffer.push_back(value);
+		if (buffer.size() == batch)
+			flush();
+	}
+
+	void flush() {
+		target.append(std::cbegin(buffer), std::cend(buffer));
+		buffer.clear();
+	}
+
+	iterator out() { return iterator(*this); }
+};
+
+void concurrent_append_benchmark(std::size_t n = 50000000, unsigned threads = std::max(2u, std::thread::hardware_concurrency()))
+{
+	std::vector<int> src(n);
+	std::iota(std::begin(src), std::end(src), 0);
+	auto is_odd_int = [](int v) {return (v % 2 == 1); };
+
+	// each thread filters its slice of src, body(t, begin, end) writes the matches somewhere shared
+	auto parallel_filter = [&](auto body) {
+		std::vector<std::thread> workers;
+		for (unsigned t = 0; t < threads; ++t)
+			workers.emplace_back([&, t] { body(t, std::cbegin(src) + n * t / threads, std::cbegin(src) + n * (t + 1) / threads); });
+		for (auto& w : workers)
+			w.join();
+	};
+
+	std::vector<int> mutex_out;
+	std::mutex out_mutex;
+	double t_mutex = elapsed_ms([&] {
+		parallel_filter([&](unsigned, auto b, auto e) {
+			for (; b != e; ++b)
+				if (is_odd_int(*b)) {
+					std::lock_guard<std::mutex> lock(out_mutex);
+					mutex_out.push_back(*b);
+				}
+		});
+	});
+
+	std::vector<int> merged;
+	double t_merge = elapsed_ms([&] {
+		std::vector<std::vector<int>> partial(threads);
+		parallel_filter([&](unsigned t, auto b, auto e) {
+			std::copy_if(b, e, std::back_inserter(partial[t]), is_odd_int);
+		});
+		std::size_t total{ 0 };
+		for (const auto& p : partial)
+			total += p.size();
+		merged.reserve(total);
+		for (const auto& p : partial)
+			merged.insert(std::end(merged), std::cbegin(p), std::cend(p));
+	});
+
+	std::vector<int> direct_out;
+	double t_direct = elapsed_ms([&] {
+		concurrent_append_vector<int> out;
+		parallel_filter([&](unsigned, auto b, auto e) {
+			for (; b != e; ++b)
+				if (is_odd_int(*b))
+					out.push_back(*b);
+		});
+		direct_out = out.compact();
+	});
+
+	std::vector<int> batched_out;
+	double t_batched = elapsed_ms([&] {
+		concurrent_append_vector<int> out;
+		parallel_filter([&](unsigned, auto b, auto e) {
+			batch_appender<int, 1024> appender(out);
+			std::copy_if(b, e, appender.out(), is_odd_int);
+		});
+		batched_out = out.compact();
+	});
+
+	// the threads interleave, so compare the sorted contents
+	for (auto* v : { &mutex_out, &direct_out, &batched_out })
+		std::sort(std::begin(*v), std::end(*v));
+	bool same = mutex_out == merged && direct_out == merged && batched_out == merged;
+
+	std::cout << "\n" << threads << " threads filtering " << n << " ints into one output\n"
+		<< "  mutex guarded std::vector             : " << t_mutex << " ms\n"
+		<< "  per-thread vectors + merge            : " << t_merge << " ms\n"
+		<< "  concurrent_append_vector::push_back   : " << t_direct << " ms (including compact())\n"
+		<< "  concurrent_append_vector + batching   : " << t_batched << " ms (including compact())"
+		<< (same ? "" : " MISMATCH") << "\n";
+}
+void front_insert_iterator_Example()
+{
+
+	// this does not work with std::vector or std::string
+	// we will use deque
+
+	std::deque<int> deq;
+
+	std::cout << "\n\nour deque 'deq' has " << deq.size() << " elements in it\n"
+		"THIS TIME we will call front_inserter, BUT we will add the elements in what will be REVERSE order\n"
+		"*it = 30;\n"
+		"*it = 44; \n\n";
+
+	auto it = std::front_inserter(deq);
+	std::cout << "Assigning to insert iterator\n";
+	*it = 30;
+	*it = 44;
+
+	//Vector elements are now {99, 88}
+	std::cout << "Deque NOW has " << deq.size() << " elements in it\n";
+
+	for (auto d : deq)
+		std::cout << d << ", ";
+	std::cout << std::endl;
+}
+
+
+// 
+// RING BUFFER DEQUE
+// 
+// std::deque keeps its elements in fixed size blocks (512 bytes in libstdc++, only 16 bytes in MSVC)
+// plus a "map" of pointers to the blocks
+//		- lots of push_front() calls keep allocating new blocks and now and then reallocate the map
+//		- iterating means hopping from block to block
+// 
+// ring_deque keeps everything in ONE contiguous buffer used as a circular buffer
+//		- push_front() and push_back() are O(1) amortised: when the buffer is full it doubles
+//		- the capacity is a power of two, so wrapping around is just a bit mask
+//		- ChunkSize is the smallest buffer it allocates (rounded up to a power of two)
+// 
+// It has push_front(), value_type and const_reference, so std::front_inserter() works with it,
+// and random access iterators, so the usual algorithms do too
+//
+
+template<typename T, std::size_t ChunkSize = 64>
+class ring_deque {
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = T&;
+	using const_reference = const T&;
+
+private:
+	T* buf{ nullptr };
+	size_type cap{ 0 };												// always 0 or a power of two
+	size_type head{ 0 };											// slot of the first element
+	size_type count{ 0 };
+	std::allocator<T> alloc;
+
+	static constexpr size_type min_capacity() {
+		size_type c{ 1 };
+		while (c < ChunkSize)
+			c <<= 1;
+		return c;
+	}
+
+	size_type slot(size_type i) const { return (head + i) & (cap - 1); }
+
+	size_type next_capacity() const { return cap ? cap * 2 : min_capacity(); }
+
+	// moves the elements to new_buf[0, count); if a copy throws, the deque is left as it was
+	void move_into(T* new_buf) {
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			if (count > 0) {											// the old contents are at most two runs: [head, cap) and [0, rest)
+				size_type first_run = std::min(count, cap - head);
+				std::memcpy(new_buf, buf + head, first_run * sizeof(T));
+				std::memcpy(new_buf + first_run, buf, (count - first_run) * sizeof(T));
+			}
+		}
+		else {
+			size_type i{ 0 };
+			try {
+				for (; i < count; ++i)
+					std::construct_at(new_buf + i, std::move_if_noexcept(buf[slot(i)]));
+			}
+			catch (...) {
+				std::destroy(new_buf, new_buf + i);
+				throw;
+			}
+			for (i = 0; i < count; ++i)
+				std::destroy_at(buf + slot(i));
+		}
+	}
+
+	void adopt(T* new_buf, size_type new_cap) {
+		if (buf)
+			alloc.deallocate(buf, cap);
+		buf = new_buf;
+		cap = new_cap;
+		head = 0;
+	}
+
+	void grow() {
+		size_type new_cap = next_capacity();
+		T* new_buf = alloc.allocate(new_cap);
+		try {
+			move_into(new_buf);
+		}
+		catch (...) {
+			alloc.deallocate(new_buf, new_cap);
+			throw;
+		}
+		adopt(new_buf, new_cap);
+	}
+
+	// grows and constructs the new element (at the back, or in the last slot for the front) before the old
+	// elements are moved, so args may refer to an element of this deque, as in d.push_back(d[0])
+	template<typename... Args>
+	T* grow_emplace(bool at_front, Args&&... args) {
+		size_type new_cap = next_capacity();
+		T* new_buf = alloc.allocate(new_cap);
+		T* p = new_buf + (at_front ? new_cap - 1 : count);
+		try {
+			std::construct_at(p, std::forward<Args>(args)...);
+		}
+		catch (...) {
+			alloc.deallocate(new_buf, new_cap);
+			throw;
+		}
+		try {
+			move_into(new_buf);
+		}
+		catch (...) {
+			std::destroy_at(p);
+			alloc.deallocate(new_buf, new_cap);
+			throw;
+		}
+		adopt(new_buf, new_cap);
+		if (at_front)
+			head = cap - 1;
+		return p;
+	}
+
+public:
+	template<bool Const>
+	class basic_iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<Const, const T*, T*>;
+		using reference = std::conditional_t<Const, const T&, T&>;
+
+	private:
+		using owner_type = std::conditional_t<Const, const ring_deque, ring_deque>;
+		owner_type* owner{ nullptr };
+		difference_type idx{ 0 };
+		friend class ring_deque;
+		basic_iterator(owner_type* owner, difference_type idx) : owner(owner), idx(idx) {}
+
+	public:
+		basic_iterator() = default;
+		operator basic_iterator<true>() const { return basic_iterator<true>(owner, idx); }
+
+		reference operator* () const { return (*owner)[idx]; }
+		pointer operator-> () const { return &(*owner)[idx]; }
+		reference operator[] (difference_type n) const { return (*owner)[idx + n]; }
+
+		basic_iterator& operator++ () { ++idx; return *this; }
+		basic_iterator operator++ (int) { auto tmp = *this; ++idx; return tmp; }
+		basic_iterator& operator-- () { --idx; return *this; }
+		basic_iterator operator-- (int) { auto tmp = *this; --idx; return tmp; }
+		basic_iterator& operator+= (difference_type n) { idx += n; return *this; }
+		basic_iterator& operator-= (difference_type n) { idx -= n; return *this; }
+
+		friend basic_iterator operator+ (basic_iterator it, difference_type n) { return it += n; }
+		friend basic_iterator operator+ (difference_type n, basic_iterator it) { return it += n; }
+		friend basic_iterator operator- (basic_iterator it, difference_type n) { return it -= n; }
+		friend difference_type operator- (const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.idx - rhs.idx; }
+
+		friend bool operator== (const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.idx == rhs.idx; }
+		friend auto operator<=> (const basic_iterator& lhs, const basic_iterator& rhs) { return lhs.idx <=> rhs.idx; }
+	};
+
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+
+	ring_deque() = default;
+
+	ring_deque(std::initializer_list<T> init) {
+		for (const auto& v : init)
+			push_back(v);
+	}
+
+	ring_deque(const ring_deque& other) {
+		for (const auto& v : other)
+			push_back(v);
+	}
+
+	ring_deque(ring_deque&& other) noexcept
+		: buf(std::exchange(other.buf, nullptr)), cap(std::exchange(other.cap, 0)),
+		head(std::exchange(other.head, 0)), count(std::exchange(other.count, 0)) {}
+
+	ring_deque& operator= (ring_deque other) noexcept {
+		std::swap(buf, other.buf);
+		std::swap(cap, other.cap);
+		std::swap(head, other.head);
+		std::swap(count, other.count);
+		return *this;
+	}
+
+	~ring_deque() {
+		clear();
+		if (buf)
+			alloc.deallocate(buf, cap);
+	}
+
+	void push_back(const T& value) { emplace_back(value); }
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+	void push_front(const T& value) { emplace_front(value); }
+	void push_front(T&& value) { emplace_front(std::move(value)); }
+
+	template<typename... Args>
+	reference emplace_back(Args&&... args) {
+		T* p = (count == cap) ? grow_emplace(false, std::forward<Args>(args)...)
+			: std::construct_at(buf + slot(count), std::forward<Args>(args)...);
+		++count;
+		return *p;
+	}
+
+	template<typename... Args>
+	reference emplace_front(Args&&... args) {
+		if (count == cap) {
+			T* p = grow_emplace(true, std::forward<Args>(args)...);
+			++count;
+			return *p;
+		}
+		size_type new_head = (head + cap - 1) & (cap - 1);
+		T* p = std::construct_at(buf + new_head, std::forward<Args>(args)...);
+		head = new_head;
+		++count;
+		return *p;
+	}
+
+	void pop_front() {
+		std::destroy_at(buf + head);
+		head = (head + 1) & (cap - 1);
+		--count;
+	}
+
+	void pop_back() {
+		std::destroy_at(buf + slot(count - 1));
+		--count;
+	}
+
+	void clear() {
+		for (size_type i = 0; i < count; ++i)
+			std::destroy_at(buf + slot(i));
+		head = 0;
+		count = 0;
+	}
 
-	for (auto v : vec)
-		std::cout << v << ", ";
-	std::cout << std::endl;
+	void reserve(size_type n) {
+		while (cap < n)
+			grow();
+	}
 
-}
-void front_insert_iterator_Example()
-{
+	reference operator[] (size_type i) { return buf[slot(i)]; }
+	const_reference operator[] (size_type i) const { return buf[slot(i)]; }
+	reference front() { return buf[head]; }
+	const_reference front() const { return buf[head]; }
+	reference back() { return buf[slot(count - 1)]; }
+	const_reference back() const { return buf[slot(count - 1)]; }
+
+	size_type size() const { return count; }
+	size_type capacity() const { return cap; }
+	bool empty() const { return count == 0; }
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, static_cast<difference_type>(count)); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, static_cast<difference_type>(count)); }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+};
 
-	// this does not work with std::vector or std::string
-	// we will use deque
+static_assert(std::random_access_iterator<ring_deque<int>::iterator>, "ring_deque iterators should be random access");
+static_assert(std::random_access_iterator<ring_deque<int>::const_iterator>, "ring_deque iterators should be random access");
 
-	std::deque<int> deq;
+void ring_deque_Example()
+{
+	ring_deque<int> deq;
 
-	std::cout << "\n\nour deque 'deq' has " << deq.size() << " elements in it\n"
-		"THIS TIME we will call front_inserter, BUT we will add the elements in what will be REVERSE order\n"
-		"*it = 30;\n"
-		"*it = 44; \n\n";
+	std::cout << "\n\nour ring_deque 'deq' has " << deq.size() << " elements in it\n";
 
 	auto it = std::front_inserter(deq);
-	std::cout << "Assigning to insert iterator\n";
+	std::cout << "Assigning to front insert iterator\n";
 	*it = 30;
 	*it = 44;
 
-	//Vector elements are now {99, 88}
-	std::cout << "Deque NOW has " << deq.size() << " elements in it\n";
+	std::cout << "ring_deque NOW has " << deq.size() << " elements in it\n";
 
 	for (auto d : deq)
 		std::cout << d << ", ";
 	std::cout << std::endl;
 }
 
+void ring_deque_benchmark()
+{
+	std::cout << "\nfront heavy producer patterns, std::deque<int> vs ring_deque<int>\n";
+
+	for (std::size_t n = 1000000; n <= 10000000; n *= 10) {
+		std::vector<int> src(n);
+		std::iota(std::begin(src), std::end(src), 0);
+
+		long long sum_std{ 0 }, sum_ring{ 0 };
+
+		// 1. fill through front_inserter, then scan everything
+		double t_std = elapsed_ms([&] {
+			std::deque<int> deq;
+			std::copy(std::cbegin(src), std::cend(src), std::front_inserter(deq));
+			sum_std = std::accumulate(std::cbegin(deq), std::cend(deq), 0LL);
+		});
+		double t_ring = elapsed_ms([&] {
+			ring_deque<int> deq;
+			std::copy(std::cbegin(src), std::cend(src), std::front_inserter(deq));
+			sum_ring = std::accumulate(std::cbegin(deq), std::cend(deq), 0LL);
+		});
+
+		std::cout << n << " ints, front_inserter fill + scan : std::deque " << t_std << " ms, ring_deque " << t_ring << " ms"
+			<< (sum_std == sum_ring ? "" : " MISMATCH") << "\n";
+
+		// 2. producer pushes at the front, consumer pops from the back, queue stays around 1000 deep
+		t_std = elapsed_ms([&] {
+			std::deque<int> deq;
+			sum_std = 0;
+			for (auto v : src) {
+				deq.push_front(v);
+				if (deq.size() > 1000) { sum_std += deq.back(); deq.pop_back(); }
+			}
+		});
+		t_ring = elapsed_ms([&] {
+			ring_deque<int> deq;
+			sum_ring = 0;
+			for (auto v : src) {
+				deq.push_front(v);
+				if (deq.size() > 1000) { sum_ring += deq.back(); deq.pop_back(); }
+			}
+		});
+
+		std::cout << n << " ints, push_front/pop_back queue  : std::deque " << t_std << " ms, ring_deque " << t_ring << " ms"
+			<< (sum_std == sum_ring ? "" : " MISMATCH") << "\n";
+	}
+}
+
 
 
 void insert_iterator_Example()
@@ -927,6 +3916,216 @@ void insert_iterator_Example()
 
 }
 
+// 
+// BATCHED POSITIONAL INSERTION
+// 
+// Every assignment to std::inserter(vec, pos) calls vec.insert(), which shifts everything after pos up by one
+//		- inserting k elements into the middle of an n element vector moves the tail k times: O(k * n)
+// 
+// batched_insert_sink collects the elements meant for one position and then inserts them
+// all with one insert() call, so the tail is only shifted once: O(k + n)
+//		- out() returns an output iterator, so it can be used with copy(), transform() and friends
+//		- the elements end up in exactly the order std::inserter() would give
+//		- commit() is called by the destructor, or call it yourself before reading the container
+//		  commit() allocates, so it can throw, and a destructor must not: the destructor drops the pending
+//		  elements if the commit fails, and does not commit at all while another exception is unwinding the stack.
+//		  Call commit() yourself when the elements must not be lost
+//
+
+template<typename Container>
+class batched_insert_sink {
+private:
+	using value_type = typename Container::value_type;
+
+	Container& container;
+	std::size_t pos;												// an index, because the container's iterators die on insert()
+	std::vector<value_type> pending;
+	int exceptions_at_start{ std::uncaught_exceptions() };
+
+public:
+	class iterator {
+	private:
+		batched_insert_sink* sink;
+	public:
+		using iterator_category = std::output_iterator_tag;
+		using value_type = void;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = void;
+
+		explicit iterator(batched_insert_sink& s) : sink(&s) {}
+		iterator& operator= (const typename Container::value_type& value) { sink->pending.push_back(value); return *this; }
+		iterator& operator= (typename Container::value_type&& value) { sink->pending.push_back(std::move(value)); return *this; }
+		iterator& operator* () { return *this; }
+		iterator& operator++ () { return *this; }
+		iterator operator++ (int) { return *this; }
+	};
+
+	batched_insert_sink(Container& c, typename Container::const_iterator where)
+		: container(c), pos(static_cast<std::size_t>(std::distance(std::cbegin(c), where))) {}
+
+	batched_insert_sink(const batched_insert_sink&) = delete;
+	batched_insert_sink& operator= (const batched_insert_sink&) = delete;
+
+	~batched_insert_sink() {
+		if (std::uncaught_exceptions() > exceptions_at_start)
+			return;												// destroyed while unwinding: leave the container alone
+		try {
+			commit();
+		}
+		catch (...) {}											// a destructor is noexcept, a throw here would be std::terminate()
+	}
+
+	iterator out() { return iterator(*this); }
+
+	std::size_t pending_size() const { return pending.size(); }
+
+	void commit() {
+		if (pending.empty())
+			return;
+		auto where = std::next(std::begin(container), static_cast<std::ptrdiff_t>(pos));
+		container.insert(where, std::make_move_iterator(std::begin(pending)), std::make_move_iterator(std::end(pending)));
+		pos += pending.size();										// like std::inserter, later elements go after the ones already inserted
+		pending.clear();
+	}
+};
+
+// 
+// GAP BUFFER
+// 
+// For repeated edits in the middle of a sequence (text editors are the classic case) we keep
+// an unused "gap" in the buffer where the edits are happening
+//		- inserting at the gap is O(1)
+//		- moving the gap costs the distance moved, so edits near each other are cheap
+//		- when the gap is used up, the buffer doubles
+//
+
+template<typename T>
+class gap_buffer {
+private:
+	std::vector<T> buf;
+	std::size_t gap_begin{ 0 };
+	std::size_t gap_end{ 0 };
+
+	std::size_t gap_size() const { return gap_end - gap_begin; }
+
+	void move_gap(std::size_t pos) {
+		if (pos < gap_begin) {
+			std::size_t n = gap_begin - pos;
+			std::move_backward(std::begin(buf) + pos, std::begin(buf) + gap_begin, std::begin(buf) + gap_end);
+			gap_begin -= n;
+			gap_end -= n;
+		}
+		else if (pos > gap_begin) {
+			std::size_t n = pos - gap_begin;
+			std::move(std::begin(buf) + gap_end, std::begin(buf) + gap_end + n, std::begin(buf) + gap_begin);
+			gap_begin += n;
+			gap_end += n;
+		}
+	}
+
+	void grow(std::size_t needed) {
+		std::size_t new_cap = std::max(buf.size() * 2, buf.size() + needed + 16);
+		std::size_t tail = buf.size() - gap_end;
+		std::vector<T> new_buf(new_cap);
+		std::move(std::begin(buf), std::begin(buf) + gap_begin, std::begin(new_buf));
+		std::move(std::begin(buf) + gap_end, std::end(buf), std::end(new_buf) - tail);
+		buf.swap(new_buf);
+		gap_end = buf.size() - tail;
+	}
+
+public:
+	gap_buffer() = default;
+
+	template<typename InputIt>
+	gap_buffer(InputIt first, InputIt last) : buf(first, last), gap_begin(buf.size()), gap_end(buf.size()) {}
+
+	std::size_t size() const { return buf.size() - gap_size(); }
+
+	const T& operator[] (std::size_t i) const { return i < gap_begin ? buf[i] : buf[i + gap_size()]; }
+	T& operator[] (std::size_t i) { return i < gap_begin ? buf[i] : buf[i + gap_size()]; }
+
+	// value is taken by value: g.insert(1, g[0]) must copy g[0] before grow() or move_gap() shifts it
+	void insert(std::size_t pos, T value) {
+		if (pos > size())
+			throw std::out_of_range("gap_buffer::insert: position past the end");
+		if (gap_size() == 0)
+			grow(1);
+		move_gap(pos);
+		buf[gap_begin++] = std::move(value);
+	}
+
+	template<typename InputIt>
+	void insert(std::size_t pos, InputIt first, InputIt last) {
+		if (pos > size())
+			throw std::out_of_range("gap_buffer::insert: position past the end");
+		std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+		if (gap_size() < n)
+			grow(n);
+		move_gap(pos);
+		std::copy(first, last, std::begin(buf) + gap_begin);
+		gap_begin += n;
+	}
+
+	void erase(std::size_t pos) {
+		if (pos >= size())
+			throw std::out_of_range("gap_buffer::erase: no element at this position");
+		move_gap(pos);
+		++gap_end;
+	}
+
+	std::vector<T> to_vector() const {
+		std::vector<T> res;
+		res.reserve(size());
+		res.insert(std::end(res), std::begin(buf), std::begin(buf) + gap_begin);
+		res.insert(std::end(res), std::begin(buf) + gap_end, std::end(buf));
+		return res;
+	}
+};
+
+void batched_insert_benchmark()
+{
+	std::cout << "\ninserting k elements into the middle of an n element std::vector<int>\n";
+
+	for (std::size_t n = 100000; n <= 1000000; n *= 10) {
+		const std::size_t k = n / 100;
+		std::vector<int> base(n), extra(k);
+		std::iota(std::begin(base), std::end(base), 0);
+		std::iota(std::begin(extra), std::end(extra), -static_cast<int>(k));
+
+		std::vector<int> a = base, b = base;
+		double t_inserter = elapsed_ms([&] {
+			std::copy(std::cbegin(extra), std::cend(extra), std::inserter(a, std::next(std::begin(a), n / 2)));
+		});
+		double t_batched = elapsed_ms([&] {
+			batched_insert_sink<std::vector<int>> sink(b, std::next(std::cbegin(b), n / 2));
+			std::copy(std::cbegin(extra), std::cend(extra), sink.out());
+		});
+
+		std::cout << "n = " << n << ", k = " << k << ": std::inserter " << t_inserter << " ms, batched_insert_sink " << t_batched << " ms"
+			<< (a == b ? "" : " MISMATCH") << "\n";
+	}
+
+	// repeated edits around a slowly moving cursor: a vector shifts the tail every time, the gap buffer hardly moves
+	const std::size_t n{ 1000000 }, edits{ 20000 };
+	std::vector<int> base(n);
+	std::iota(std::begin(base), std::end(base), 0);
+	std::vector<int> vec = base;
+	gap_buffer<int> gap(std::cbegin(base), std::cend(base));
+
+	double t_vec = elapsed_ms([&] {
+		for (std::size_t i = 0; i < edits; ++i)
+			vec.insert(std::begin(vec) + (n / 2 + i % 64), static_cast<int>(i));
+	});
+	double t_gap = elapsed_ms([&] {
+		for (std::size_t i = 0; i < edits; ++i)
+			gap.insert(n / 2 + i % 64, static_cast<int>(i));
+	});
+
+	std::cout << edits << " edits near the middle of " << n << " ints: std::vector::insert " << t_vec << " ms, gap_buffer " << t_gap << " ms"
+		<< (vec == gap.to_vector() ? "" : " MISMATCH") << "\n";
+}
+
 
 // 
 // LIbrary Function objects
@@ -951,47 +4150,767 @@ void less_library_implementation()
 
 	std::cout << "Vector before sort(): ";
 
-	for (auto name : names)
+	for (const auto& name : names)
+		std::cout << name << ", ";
+	std::cout << std::endl << std::endl;
+
+	std::sort(std::begin(names), std::end(names), std::greater<std::string>());		//greater will sort in reverse alphabetical order
+
+	std::cout << "Vector after sort() call...\n";
+
+	for (const auto& name : names)
 		std::cout << name << ", ";
 	std::cout << std::endl << std::endl;
+}
+
+// 
+// COMPILE TIME TABLES
+// 
+// The name lists in sorting(), sorting_with_object() and less_library_implementation() are written
+// into the program, but they are copied into a vector and sorted every time the function runs
+// 
+// In c++20 std::sort() is constexpr, so a std::array of std::string_view literals can be sorted
+// by the compiler: the sorted table is just data in the executable, nothing runs at startup
+// 
+// For "is this name in the table?" we can go one step further and build a minimal perfect hash,
+// also at compile time
+//		- every key gets its own slot, N keys use exactly N slots
+//		- keys are hashed into buckets, then for each bucket (biggest first) we search for a seed
+//		  which sends all of its keys to free slots, and remember that seed
+//		- a lookup is one hash, one seed read and one string compare, no probing or branching on collisions
+//
+
+template<std::size_t N, typename Compare = std::less<>>
+constexpr std::array<std::string_view, N> constexpr_sorted(std::array<std::string_view, N> names, Compare comp = Compare())
+{
+	std::sort(std::begin(names), std::end(names), comp);
+	return names;
+}
+
+// FNV-1a: the key is hashed once, the bucket comes from the hash and the slot from the hash remixed with the bucket's seed
+constexpr std::uint64_t fnv1a_hash(std::string_view key)
+{
+	std::uint64_t h = 14695981039346656037ull;
+	for (char c : key) {
+		h ^= static_cast<unsigned char>(c);
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+constexpr std::uint64_t remix(std::uint64_t h, std::uint64_t seed)
+{
+	h ^= seed * 0x9E3779B97F4A7C15ull;
+	h *= 0xFF51AFD7ED558CCDull;
+	return h ^ (h >> 33);
+}
+
+template<std::size_t N>
+class perfect_hash_table {
+private:
+	std::array<std::string_view, N> slots{};					// slots[i] is the key which hashes to i
+	std::array<std::uint32_t, N> seeds{};						// seed chosen for each bucket
+
+public:
+	constexpr explicit perfect_hash_table(const std::array<std::string_view, N>& keys) {
+		// bucket every key by its seed 0 hash
+		std::array<std::uint64_t, N> hashes{};
+		std::array<std::size_t, N> bucket_of{}, bucket_size{}, order{};
+		for (std::size_t i = 0; i < N; ++i) {
+			hashes[i] = fnv1a_hash(keys[i]);
+			bucket_of[i] = hashes[i] % N;
+			++bucket_size[bucket_of[i]];
+		}
+		for (std::size_t b = 0; b < N; ++b)
+			order[b] = b;
+		std::sort(std::begin(order), std::end(order),
+			[&bucket_size](std::size_t lhs, std::size_t rhs) {return bucket_size[lhs] > bucket_size[rhs]; });
+
+		std::array<bool, N> taken{};
+		for (std::size_t b : order) {
+			if (bucket_size[b] == 0)
+				break;
+			for (std::uint32_t seed = 1; ; ++seed) {				// keys must be distinct, or this never ends
+				std::array<std::size_t, N> trial{};
+				std::size_t placed{ 0 };
+				bool ok{ true };
+				for (std::size_t i = 0; i < N && ok; ++i) {
+					if (bucket_of[i] != b)
+						continue;
+					std::size_t slot = remix(hashes[i], seed) % N;
+					for (std::size_t j = 0; j < placed; ++j)
+						ok = ok && trial[j] != slot;
+					ok = ok && !taken[slot];
+					trial[placed++] = slot;
+				}
+				if (!ok)
+					continue;
+				placed = 0;
+				for (std::size_t i = 0; i < N; ++i) {
+					if (bucket_of[i] != b)
+						continue;
+					taken[trial[placed]] = true;
+					slots[trial[placed++]] = keys[i];
+				}
+				seeds[b] = seed;
+				break;
+			}
+		}
+	}
+
+	// slot of key, or N if it is not in the table
+	constexpr std::size_t index_of(std::string_view key) const {
+		std::uint64_t h = fnv1a_hash(key);
+		std::size_t slot = remix(h, seeds[h % N]) % N;
+		return slots[slot] == key ? slot : N;
+	}
+
+	constexpr bool contains(std::string_view key) const { return index_of(key) != N; }
+	constexpr std::string_view operator[] (std::size_t slot) const { return slots[slot]; }
+	static constexpr std::size_t size() { return N; }
+};
+
+// the literal lists used in sorting(), sorting_with_object() and less_library_implementation()
+inline constexpr std::array<std::string_view, 6> sorting_names{ "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili" };
+inline constexpr std::array<std::string_view, 6> object_names{ "Mark", "Pewdie", "KSI", "Cherno", "William", "Disney" };
+inline constexpr std::array<std::string_view, 7> library_names{ "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili", "Priscilla" };
+
+inline constexpr auto sorting_names_alphabetical = constexpr_sorted(sorting_names);
+inline constexpr auto object_names_by_length = constexpr_sorted(object_names, is_shorter_2());
+inline constexpr auto library_names_reversed = constexpr_sorted(library_names, std::greater<>());
+inline constexpr perfect_hash_table<7> library_name_set{ library_names };
+
+static_assert(sorting_names_alphabetical.front() == "Benjamin" && sorting_names_alphabetical.back() == "William");
+static_assert(library_names_reversed.front() == "William");
+static_assert(library_name_set.contains("Priscilla") && !library_name_set.contains("Kim"));
+
+void constexpr_tables_Example()
+{
+	std::cout << "\nsorted at compile time, alphabetically: ";
+	for (auto name : sorting_names_alphabetical)
+		std::cout << name << ", ";
+
+	std::cout << "\nsorted at compile time, by length (is_shorter_2): ";
+	for (auto name : object_names_by_length)
+		std::cout << name << ", ";
+
+	std::cout << "\nsorted at compile time, std::greater<>: ";
+	for (auto name : library_names_reversed)
+		std::cout << name << ", ";
+
+	std::cout << "\nperfect hash slots: ";
+	for (std::size_t i = 0; i < library_name_set.size(); ++i)
+		std::cout << i << "=" << library_name_set[i] << ", ";
+	std::cout << "\n\"Stan\" is in slot " << library_name_set.index_of("Stan")
+		<< ", \"Kim\" is" << (library_name_set.contains("Kim") ? "" : " NOT") << " in the table" << std::endl;
+}
+
+void constexpr_tables_benchmark(std::size_t lookups = 10000000)
+{
+	const std::size_t calls{ 100000 };
+	std::size_t sink{ 0 };
+
+	// startup: what sorting() does every call, against reading the compile time table
+	double t_runtime_sort = elapsed_ms([&] {
+		for (std::size_t i = 0; i < calls; ++i) {
+			std::vector<std::string> names = { "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili", "Priscilla" };
+			std::sort(std::begin(names), std::end(names), std::greater<std::string>());
+			sink += names.front().size();
+		}
+	});
+	double t_constexpr_sort = elapsed_ms([&] {
+		for (std::size_t i = 0; i < calls; ++i) {
+			const auto& names = library_names_reversed;
+			sink += names[i % names.size()].size();
+		}
+	});
+
+	std::cout << "\n" << calls << " calls, building and sorting the name list\n"
+		<< "  std::vector<std::string> + std::sort : " << t_runtime_sort << " ms\n"
+		<< "  constexpr sorted std::array          : " << t_constexpr_sort << " ms\n";
+
+	// lookups: half of the queries are in the table
+	std::vector<std::string> table(std::cbegin(library_names), std::cend(library_names));
+	const std::array<std::string_view, 10> queries{ "Stan", "Kim", "Priscilla", "Jo", "William", "Allice", "Nick", "Rebecca-Jane", "Vassili", "Dax" };
+	std::size_t h1{ 0 }, h2{ 0 }, h3{ 0 };
+
+	double t_find = elapsed_ms([&] {
+		for (std::size_t i = 0; i < lookups; ++i)
+			h1 += std::find(std::cbegin(table), std::cend(table), queries[i % queries.size()]) != std::cend(table);
+	});
+	constexpr auto alphabetical = constexpr_sorted(library_names);
+	double t_binary = elapsed_ms([&] {
+		for (std::size_t i = 0; i < lookups; ++i)
+			h2 += std::binary_search(std::cbegin(alphabetical), std::cend(alphabetical), queries[i % queries.size()]);
+	});
+	double t_hash = elapsed_ms([&] {
+		for (std::size_t i = 0; i < lookups; ++i)
+			h3 += library_name_set.contains(queries[i % queries.size()]);
+	});
+
+	std::cout << lookups << " membership lookups\n"
+		<< "  std::find over std::vector<std::string> : " << t_find << " ms (" << h1 << " hits)\n"
+		<< "  binary_search over constexpr table      : " << t_binary << " ms (" << h2 << " hits)\n"
+		<< "  constexpr perfect_hash_table            : " << t_hash << " ms (" << h3 << " hits)\n"
+		<< (sink == 0 ? "\n" : "");
+}
+
+// 
+// EXTERNAL MERGE SORT
+// 
+// std::sort() needs every name in memory at once. When the list is bigger than the memory we are
+// allowed to use, we sort it in two phases:
+// 
+//	1. Run formation: read names until the memory budget is used up, sort them with the comparator,
+//	   and write them to a temporary "run" file. Each name is written as a 4 byte length followed by
+//	   the characters, so reading it back needs no parsing
+// 
+//	2. k-way merge: open every run and repeatedly output the smallest front element
+//		- the smallest front element is found with a "loser tree": every internal node remembers the
+//		  loser of the match played there, so replacing the winner only replays one leaf-to-root path,
+//		  about log2(k) comparisons
+//		- each run is read through two buffers: while we consume one, the next block is being read
+//		  by the run's own reader thread, so the merge does not wait for the disk
+// 
+// Any comparator which works with std::sort() works here: operator<, is_shorter, std::greater<std::string>()...
+// Equal elements come out in input order, so sorting by is_shorter is stable
+// 
+// All runs are merged in one pass, so the budget should allow a read buffer for each run
+// 
+// If the input cannot be read, a run file cannot be written, or writing the output fails, external_sort()
+// throws std::runtime_error instead of leaving a truncated file behind; the run files are removed either way
+//
+
+// reads length-prefixed records from a run file, one thread per run reads the next block in the background
+class run_reader {
+private:
+	std::string path;
+	std::ifstream in;
+	std::vector<char> front, back;								// front is being consumed, back belongs to the reader thread until back_ready
+	std::size_t front_len{ 0 }, front_pos{ 0 }, back_len{ 0 };
+	bool at_end{ false };
+
+	std::mutex m;
+	std::condition_variable cv;
+	bool want_read{ true }, back_ready{ false }, stopping{ false }, read_failed{ false };
+	std::thread reader;											// last, so everything above exists before it starts
+
+	void read_loop() {
+		std::unique_lock<std::mutex> lock(m);
+		for (;;) {
+			cv.wait(lock, [this] { return want_read || stopping; });
+			if (stopping)
+				return;
+			want_read = false;
+			lock.unlock();
+			in.read(back.data(), static_cast<std::streamsize>(back.size()));
+			std::size_t n = static_cast<std::size_t>(in.gcount());
+			bool failed = in.bad();
+			lock.lock();
+			back_len = n;
+			read_failed = failed;
+			back_ready = true;
+			cv.notify_all();
+		}
+	}
+
+	// waits for the block being read, makes it the front one and asks for the next
+	bool next_block() {
+		if (at_end)
+			return false;
+		std::unique_lock<std::mutex> lock(m);
+		cv.wait(lock, [this] { return back_ready; });
+		if (read_failed)
+			throw std::runtime_error("external_sort: cannot read run file " + path);
+		back_ready = false;
+		front.swap(back);
+		front_len = back_len;
+		front_pos = 0;
+		if (front_len == 0) {
+			at_end = true;
+			return false;
+		}
+		want_read = true;
+		cv.notify_all();
+		return true;
+	}
+
+	// copy n bytes into dst, switching buffers as needed, false at the end of the file
+	bool read_bytes(char* dst, std::size_t n) {
+		while (n > 0) {
+			if (front_pos == front_len && !next_block())
+				return false;
+			std::size_t chunk = std::min(n, front_len - front_pos);
+			std::memcpy(dst, front.data() + front_pos, chunk);
+			front_pos += chunk;
+			dst += chunk;
+			n -= chunk;
+		}
+		return true;
+	}
+
+public:
+	run_reader(const std::string& path, std::size_t buffer_size)
+		: path(path), in(path, std::ios::binary), front(buffer_size), back(buffer_size) {
+		if (!in)
+			throw std::runtime_error("external_sort: cannot open run file " + path);
+		reader = std::thread(&run_reader::read_loop, this);
+	}
+
+	run_reader(const run_reader&) = delete;
+	run_reader& operator= (const run_reader&) = delete;
+
+	~run_reader() {
+		{
+			std::lock_guard<std::mutex> lock(m);
+			stopping = true;
+		}
+		cv.notify_all();
+		reader.join();
+	}
+
+	bool next(std::string& out) {
+		std::uint32_t len{ 0 };
+		if (!read_bytes(reinterpret_cast<char*>(&len), sizeof(len)))
+			return false;
+		out.resize(len);
+		return read_bytes(out.data(), len);
+	}
+};
+
+// tournament tree of losers over k sources, tree[0] holds the overall winner
+template<typename Compare>
+class loser_tree {
+private:
+	const std::vector<std::string>& heads;						// current front element of every source
+	const std::vector<bool>& done;								// source exhausted, it loses every match
+	Compare comp;
+	std::size_t k;
+	std::vector<std::size_t> tree;
+
+	bool beats(std::size_t a, std::size_t b) const {
+		if (done[a]) return false;
+		if (done[b]) return true;
+		if (comp(heads[a], heads[b])) return true;
+		if (comp(heads[b], heads[a])) return false;
+		return a < b;											// ties go to the earlier run, which keeps the sort stable
+	}
+
+	std::size_t build(std::size_t node) {
+		if (node >= k)
+			return node - k;									// leaves are nodes k..2k-1
+		std::size_t lhs = build(2 * node), rhs = build(2 * node + 1);
+		if (beats(lhs, rhs)) { tree[node] = rhs; return lhs; }
+		tree[node] = lhs;
+		return rhs;
+	}
+
+public:
+	loser_tree(const std::vector<std::string>& heads, const std::vector<bool>& done, Compare comp)
+		: heads(heads), done(done), comp(comp), k(heads.size()), tree(std::max<std::size_t>(k, 1)) {
+		tree[0] = (k == 1) ? 0 : build(1);
+	}
+
+	std::size_t winner() const { return tree[0]; }
+
+	// call after the winner's source has moved on to its next element
+	void replay() {
+		std::size_t w = tree[0];
+		for (std::size_t node = (w + k) / 2; node >= 1; node /= 2)
+			if (beats(tree[node], w))
+				std::swap(tree[node], w);
+		tree[0] = w;
+	}
+};
+
+struct external_sort_stats {
+	std::size_t lines{ 0 };
+	std::size_t runs{ 0 };
+};
+
+template<typename Compare = std::less<>>
+external_sort_stats external_sort(const std::string& input_path, const std::string& output_path,
+	std::size_t memory_budget, Compare comp = Compare())
+{
+	namespace fs = std::filesystem;
+	static std::atomic<unsigned> sort_id{ 0 };
+	const std::string prefix = (fs::temp_directory_path() / ("external_sort_" + std::to_string(sort_id++) + "_run_")).string();
+
+	// removes the run files however we leave, error_code so the destructor cannot throw
+	struct run_files {
+		std::vector<std::string> paths;
+		~run_files() {
+			std::error_code ec;
+			for (const auto& p : paths)
+				fs::remove(p, ec);
+		}
+	} runs;
+	std::vector<std::string>& run_paths = runs.paths;
+
+	external_sort_stats stats;
+
+	// 1. run formation
+	{
+		std::ifstream in(input_path, std::ios::binary);
+		if (!in)
+			throw std::runtime_error("external_sort: cannot open " + input_path);
+		std::vector<std::string> chunk;
+		std::size_t used{ 0 };
+		std::string line;
+
+		auto spill = [&] {
+			std::stable_sort(std::begin(chunk), std::end(chunk), comp);
+			run_paths.push_back(prefix + std::to_string(run_paths.size()) + ".bin");
+			std::ofstream out(run_paths.back(), std::ios::binary);
+			if (!out)
+				throw std::runtime_error("external_sort: cannot create run file " + run_paths.back());
+			for (const auto& s : chunk) {
+				auto len = static_cast<std::uint32_t>(s.size());
+				out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+				out.write(s.data(), len);
+			}
+			out.close();
+			if (!out)
+				throw std::runtime_error("external_sort: cannot write run file " + run_paths.back());
+			chunk.clear();
+			used = 0;
+		};
+
+		while (std::getline(in, line)) {
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			used += sizeof(std::string) + (line.size() > 15 ? line.size() + 1 : 0);
+			chunk.push_back(std::move(line));
+			++stats.lines;
+			if (used >= memory_budget)
+				spill();
+		}
+		if (in.bad())
+			throw std::runtime_error("external_sort: cannot read " + input_path);
+		if (!chunk.empty() || run_paths.empty())
+			spill();
+	}
+	stats.runs = run_paths.size();
+
+	// 2. k-way merge, each run gets two read buffers out of the budget
+	{
+		const std::size_t k = run_paths.size();
+		const std::size_t buffer_size = std::max<std::size_t>(memory_budget / (4 * k), 64 * 1024);
+
+		std::vector<std::unique_ptr<run_reader>> readers;
+		std::vector<std::string> heads(k);
+		std::vector<bool> done(k);
+		for (std::size_t i = 0; i < k; ++i) {
+			readers.push_back(std::make_unique<run_reader>(run_paths[i], buffer_size));
+			done[i] = !readers[i]->next(heads[i]);
+		}
+
+		std::vector<char> out_buf(buffer_size);					// declared before out, so it outlives the stream's last flush
+		std::ofstream out(output_path, std::ios::binary);
+		if (!out)
+			throw std::runtime_error("external_sort: cannot create " + output_path);
+		out.rdbuf()->pubsetbuf(out_buf.data(), static_cast<std::streamsize>(out_buf.size()));
+
+		loser_tree<Compare> tournament(heads, done, comp);
+		while (!done[tournament.winner()]) {
+			std::size_t w = tournament.winner();
+			out.write(heads[w].data(), static_cast<std::streamsize>(heads[w].size()));
+			out.put('\n');
+			done[w] = !readers[w]->next(heads[w]);
+			tournament.replay();
+		}
+		out.close();
+		if (!out)
+			throw std::runtime_error("external_sort: cannot write " + output_path);
+	}
+
+	return stats;
+}
+
+void external_sort_benchmark(std::size_t memory_budget = 8 * 1024 * 1024)
+{
+	const std::string input{ "external_sort_input.txt" }, output{ "external_sort_output.txt" };
+	const char* stems[] = { "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili", "Priscilla", "Rebecca-Jane-Nataliana" };
+
+	std::cout << "\nexternal sort with a " << memory_budget / 1024 << " KB budget\n";
+
+	for (std::size_t factor : { 4, 10 }) {
+		// generate names until the in-memory size is about factor * budget
+		std::size_t lines{ 0 };
+		{
+			std::ofstream out(input, std::ios::binary);
+			std::mt19937 rng(42);
+			std::size_t bytes{ 0 };
+			while (bytes < factor * memory_budget) {
+				std::string name = std::string(stems[rng() % 8]) + "_" + std::to_string(rng() % 1000000);
+				bytes += sizeof(std::string) + (name.size() > 15 ? name.size() + 1 : 0);
+				out << name << '\n';
+				++lines;
+			}
+		}
+
+		auto check = [&](auto comp) {
+			std::ifstream in(output, std::ios::binary);
+			std::string prev, cur;
+			std::size_t count{ 0 };
+			bool ok{ true };
+			while (std::getline(in, cur)) {
+				if (count++ > 0 && comp(cur, prev))
+					ok = false;
+				prev.swap(cur);
+			}
+			return ok && count == lines;
+		};
+
+		external_sort_stats stats;
+		double t_less = elapsed_ms([&] { stats = external_sort(input, output, memory_budget); });
+		bool ok_less = check(std::less<>());
+		double t_shorter = elapsed_ms([&] { external_sort(input, output, memory_budget, is_shorter); });
+		bool ok_shorter = check(is_shorter);
+		double t_greater = elapsed_ms([&] { external_sort(input, output, memory_budget, std::greater<std::string>()); });
+		bool ok_greater = check(std::greater<std::string>());
+
+		// the in-memory version for comparison, which needs factor times the budget
+		double t_memory = elapsed_ms([&] {
+			std::ifstream in(input, std::ios::binary);
+			std::vector<std::string> names;
+			std::string line;
+			while (std::getline(in, line))
+				names.push_back(line);
+			std::sort(std::begin(names), std::end(names));
+			std::ofstream out(output, std::ios::binary);
+			for (const auto& name : names)
+				out << name << '\n';
+		});
+
+		std::cout << lines << " names (" << factor << "x the budget), " << stats.runs << " runs:\n"
+			<< "  external_sort, operator<    : " << t_less << " ms" << (ok_less ? "" : " NOT SORTED") << "\n"
+			<< "  external_sort, is_shorter   : " << t_shorter << " ms" << (ok_shorter ? "" : " NOT SORTED") << "\n"
+			<< "  external_sort, greater<>    : " << t_greater << " ms" << (ok_greater ? "" : " NOT SORTED") << "\n"
+			<< "  in memory std::sort         : " << t_memory << " ms\n";
+	}
+
+	std::remove(input.c_str());
+	std::remove(output.c_str());
+}
+
+void Arithmetical_library_operators()
+{
+	std::string a{ "Hello " };
+	const char* b{ "World" };
+
+	std::string res = std::plus<>{}(a, b);
+
+	std::cout << "std::string a{ \"Hello \" };\n"
+		"const char* b{ \"World\" };\n"
+		"std::string res = std::plus<>{}(a, b);\n"
+		"result of adding a + b=  " << res << "\n";
+
+
+	//std::minus requires #include<numeric>, and is an argument call for an accumulator
+	int arr[] = { 50,30 };
+	int diff1 = std::accumulate(arr, arr + 2, 100, std::minus<int>());
+	std::cout << "\nint arr[] = { 50,30 };\n"
+		"int diff1 = std::accumulate(arr,arr+2, 100, std::minus<int>());\n"
+		"The end result of 100-50-30 = " << diff1 << "\n";
+
+
+	int diff2 = std::accumulate(arr, arr + 1, 100, std::minus<int>());
+	std::cout << "\nint arr[] = { 50,30 };\n"
+		"int diff2 = std::accumulate(arr, arr + 1, 100, std::minus<int>());\n"
+		"The end result of 100-50-0 = " << diff2 << "\n";
+
+
+	std::cout << "\nmore can be found at https://en.cppreference.com/w/cpp/utility/functional" << "\n";
+}
+
+// 
+// PARALLEL SCANS (PREFIX SUMS)
+// 
+// std::accumulate() folds a range down to one value. A "scan" keeps every intermediate value:
+//		inclusive scan of {3, 1, 4, 1}  ->  {3, 4, 8, 9}
+//		exclusive scan of {3, 1, 4, 1}  ->  {0, 3, 4, 8}		(starts from init, leaves the current element out)
+// transform_exclusive_scan() applies a function first; with the string sizes it gives the offset of every
+// string in a packed buffer
+// 
+// Scanning looks sequential, every output needs the one before, but with an associative operation
+// it can be done in two passes over blocks:
+//		1. every thread reduces its own block to a single value
+//		2. a short sequential scan over those block totals gives each block its starting carry
+//		3. every thread scans its block again, starting from its carry
+// 
+// For int with std::plus the block scan works 4 elements at a time in an SSE2 register:
+//		add the register shifted by one element, then by two, and every lane holds its prefix sum
+// 
+// std::minus is not associative, (a - b) - c != a - (b - c), but a - b - c == a + (-b) + (-c),
+// so a minus scan is run as a plus scan over the negated elements
+//
+
+template<typename Op>
+inline constexpr bool is_minus_op_v = false;
+
+template<typename T>
+inline constexpr bool is_minus_op_v<std::minus<T>> = true;
+
+template<typename T, typename Op>
+inline constexpr bool is_simd_int_plus_v = std::is_same_v<T, int> && (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<int>>);
+
+// inclusive scan of in[0, n) into out, every output also gets carry added
+template<typename T, typename Op>
+T block_inclusive_scan(const T* in, T* out, std::size_t n, T carry, bool has_carry, Op op)
+{
+	std::size_t i{ 0 };
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	if constexpr (is_simd_int_plus_v<T, Op>) {
+		__m128i running = _mm_set1_epi32(has_carry ? carry : 0);
+		for (; i + 4 <= n; i += 4) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+			x = _mm_add_epi32(x, _mm_slli_si128(x, 4));				// lanes: a, a+b, b+c, c+d
+			x = _mm_add_epi32(x, _mm_slli_si128(x, 8));				// lanes: a, a+b, a+b+c, a+b+c+d
+			x = _mm_add_epi32(x, running);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+			running = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));	// broadcast the last lane
+		}
+		if (i > 0) {
+			carry = out[i - 1];
+			has_carry = true;
+		}
+	}
+#endif
+	for (; i < n; ++i) {
+		carry = has_carry ? op(carry, in[i]) : in[i];
+		has_carry = true;
+		out[i] = carry;
+	}
+	return carry;
+}
 
-	std::sort(std::begin(names), std::end(names), std::greater<std::string>());		//greater will sort in reverse alphabetical order
+template<typename T, typename Op>
+void parallel_inclusive_scan_impl(const T* in, T* out, std::size_t n, std::optional<T> init, Op op, unsigned threads)
+{
+	threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(n / 65536 + 1)));
+	if (threads == 1) {
+		block_inclusive_scan(in, out, n, init.value_or(T{}), init.has_value(), op);
+		return;
+	}
 
-	std::cout << "Vector after sort() call...\n";
+	auto block_begin = [n, threads](unsigned t) { return n * t / threads; };
+
+	// pass 1: reduce every block (the first one already folds in init)
+	std::vector<T> totals(threads);
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t)
+		workers.emplace_back([&, t] {
+			std::size_t b = block_begin(t), e = block_begin(t + 1);
+			T acc = (t == 0 && init) ? op(*init, in[b]) : in[b];
+			for (std::size_t i = b + 1; i < e; ++i)
+				acc = op(acc, in[i]);
+			totals[t] = acc;
+		});
+	for (auto& w : workers)
+		w.join();
+	workers.clear();
+
+	// the carries, a sequential scan over threads values
+	std::vector<T> carries(threads);
+	for (unsigned t = 1; t < threads; ++t)
+		carries[t] = (t == 1) ? totals[0] : op(carries[t - 1], totals[t - 1]);
+
+	// pass 2: scan every block from its carry
+	for (unsigned t = 0; t < threads; ++t)
+		workers.emplace_back([&, t] {
+			std::size_t b = block_begin(t), e = block_begin(t + 1);
+			if (t == 0)
+				block_inclusive_scan(in + b, out + b, e - b, init.value_or(T{}), init.has_value(), op);
+			else
+				block_inclusive_scan(in + b, out + b, e - b, carries[t], true, op);
+		});
+	for (auto& w : workers)
+		w.join();
+}
 
-	for (auto name : names)
-		std::cout << name << ", ";
-	std::cout << std::endl << std::endl;
+template<typename T, typename Op = std::plus<>>
+void parallel_inclusive_scan(const std::vector<T>& in, std::vector<T>& out, Op op = Op(), unsigned threads = std::thread::hardware_concurrency())
+{
+	out.resize(in.size());
+	if (in.empty())
+		return;
+	if constexpr (is_minus_op_v<Op>) {
+		std::vector<T> negated(in.size());
+		negated[0] = in[0];
+		std::transform(std::cbegin(in) + 1, std::cend(in), std::begin(negated) + 1, std::negate<T>());
+		parallel_inclusive_scan_impl(negated.data(), out.data(), in.size(), std::optional<T>(), std::plus<T>(), threads);
+	}
+	else {
+		parallel_inclusive_scan_impl(in.data(), out.data(), in.size(), std::optional<T>(), op, threads);
+	}
 }
 
-void Arithmetical_library_operators()
+template<typename T, typename Op = std::plus<>>
+void parallel_exclusive_scan(const std::vector<T>& in, std::vector<T>& out, T init, Op op = Op(), unsigned threads = std::thread::hardware_concurrency())
 {
-	std::string a{ "Hello " };
-	const char* b{ "World" };
+	out.resize(in.size());
+	if (in.empty())
+		return;
+	// exclusive = init followed by the inclusive scan (seeded with init) of everything but the last element
+	out[0] = init;
+	if constexpr (is_minus_op_v<Op>) {
+		std::vector<T> negated(in.size() - 1);
+		std::transform(std::cbegin(in), std::cend(in) - 1, std::begin(negated), std::negate<T>());
+		parallel_inclusive_scan_impl(negated.data(), out.data() + 1, negated.size(), std::optional<T>(init), std::plus<T>(), threads);
+	}
+	else {
+		parallel_inclusive_scan_impl(in.data(), out.data() + 1, in.size() - 1, std::optional<T>(init), op, threads);
+	}
+}
 
-	std::string res = std::plus<>{}(a, b);
+template<typename InputIt, typename T, typename BinaryOp, typename UnaryOp>
+void parallel_transform_exclusive_scan(InputIt first, InputIt last, std::vector<T>& out, T init, BinaryOp op, UnaryOp transform,
+	unsigned threads = std::thread::hardware_concurrency())
+{
+	std::vector<T> values(static_cast<std::size_t>(std::distance(first, last)));
+	std::transform(first, last, std::begin(values), transform);
+	parallel_exclusive_scan(values, out, init, op, threads);
+}
 
-	std::cout << "std::string a{ \"Hello \" };\n"
-		"const char* b{ \"World\" };\n"
-		"std::string res = std::plus<>{}(a, b);\n"
-		"result of adding a + b=  " << res << "\n";
+void string_offsets_Example()
+{
+	std::vector<std::string> names = { "William", "Benjamin", "Nick", "Stan", "Finguy", "Vassili" };
 
+	// where does every name start if they are packed one after another?
+	std::vector<std::size_t> offsets;
+	parallel_transform_exclusive_scan(std::cbegin(names), std::cend(names), offsets, std::size_t{ 0 }, std::plus<>(),
+		[](const std::string& s) {return s.size(); });
 
-	//std::minus requires #include<numeric>, and is an argument call for an accumulator
-	int arr[] = { 50,30 };
-	int diff1 = std::accumulate(arr, arr + 2, 100, std::minus<int>());
-	std::cout << "\nint arr[] = { 50,30 };\n"
-		"int diff1 = std::accumulate(arr,arr+2, 100, std::minus<int>());\n"
-		"The end result of 100-50-30 = " << diff1 << "\n";
+	std::cout << "\npacked offsets: ";
+	for (std::size_t i = 0; i < names.size(); ++i)
+		std::cout << names[i] << " @ " << offsets[i] << ", ";
 
+	std::vector<int> arr{ 50, 30 }, diffs;
+	parallel_exclusive_scan(arr, diffs, 100, std::minus<int>());
+	std::cout << "\nexclusive minus scan of { 50,30 } from 100: " << diffs[0] << ", " << diffs[1];
+	parallel_inclusive_scan(arr, diffs, std::minus<int>());
+	std::cout << "\ninclusive minus scan of { 50,30 }: " << diffs[0] << ", " << diffs[1] << std::endl;
+}
 
-	int diff2 = std::accumulate(arr, arr + 1, 100, std::minus<int>());
-	std::cout << "\nint arr[] = { 50,30 };\n"
-		"int diff2 = std::accumulate(arr, arr + 1, 100, std::minus<int>());\n"
-		"The end result of 100-50-0 = " << diff2 << "\n";
+// four int vectors of max_elements each: 1.6 GB at the default, 100M; 1000000000 needs about 16 GB
+void parallel_scan_benchmark(std::size_t max_elements = 100000000)
+{
+	std::cout << "\ninclusive scan with std::plus<int>\n";
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
 
+	for (std::size_t n = 1000000; n <= max_elements; n *= 10) {
+		std::vector<int> in(n), seq(n), par(n), single(n);
+		for (std::size_t i = 0; i < n; ++i)
+			in[i] = static_cast<int>(i % 3) - 1;						// -1, 0, 1: the sums stay small
 
-	std::cout << "\nmore can be found at https://en.cppreference.com/w/cpp/utility/functional" << "\n";
+		double t_partial = elapsed_ms([&] { std::partial_sum(std::cbegin(in), std::cend(in), std::begin(seq)); });
+		double t_simd = elapsed_ms([&] { parallel_inclusive_scan(in, single, std::plus<int>(), 1); });
+		double t_parallel = elapsed_ms([&] { parallel_inclusive_scan(in, par, std::plus<int>(), threads); });
+
+		std::cout << n << " ints: std::partial_sum " << t_partial << " ms, SIMD scan (1 thread) " << t_simd << " ms, "
+			<< "parallel scan (" << threads << " threads) " << t_parallel << " ms" << (seq == par && seq == single ? "" : " MISMATCH") << "\n";
+	}
 }
 
 void Relational_library_operators()
@@ -1055,20 +4974,871 @@ void bitwise_operators()
 
 }
 
+// 
+// SMALL CONTAINERS WITHOUT THE HEAP
+// 
+// Arithmetical_library_operators() uses int arr[] = { 50,30 }, Logical_operators() uses bool[4], and the global
+// vec holds six ints. A std::vector for six ints costs a heap allocation (and a free), and every element
+// access goes through a pointer to memory somewhere else
+// 
+// static_vector<T, N>		room for N elements inside the object itself, never allocates
+//							like an array, but with a size, push_back() and insert(); going past N throws std::length_error
+// small_vector<T, N>		the same inline room, and when the (N + 1)th element arrives it moves everything
+//							to the heap and carries on like a std::vector
+// 
+// Both keep their elements contiguous, so the iterators are plain pointers and find_if(), transform(),
+// accumulate() and the rest work on them unchanged. They have value_type, push_back() and insert(pos, value),
+// so std::back_inserter() and std::inserter() work too
+//
+
+template<typename T, std::size_t N>
+class static_vector {
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+private:
+	alignas(T) std::byte storage[N * sizeof(T)];
+	size_type count{ 0 };
+
+public:
+	static_vector() = default;
+
+	static_vector(std::initializer_list<T> init) {
+		for (const auto& v : init)
+			push_back(v);
+	}
+
+	static_vector(const static_vector& other) {
+		for (const auto& v : other)
+			push_back(v);
+	}
+
+	static_vector(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		for (auto& v : other)
+			push_back(std::move(v));
+	}
+
+	static_vector& operator= (static_vector other) {
+		clear();
+		for (auto& v : other)
+			push_back(std::move(v));
+		return *this;
+	}
+
+	~static_vector() { clear(); }
+
+	void push_back(const T& value) { emplace_back(value); }
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+
+	template<typename... Args>
+	reference emplace_back(Args&&... args) {
+		if (count == N)
+			throw std::length_error("static_vector is full");
+		T* p = std::construct_at(data() + count, std::forward<Args>(args)...);
+		++count;
+		return *p;
+	}
+
+	iterator insert(const_iterator pos, T value) {
+		auto i = pos - begin();
+		emplace_back(std::move(value));
+		std::rotate(begin() + i, end() - 1, end());
+		return begin() + i;
+	}
+
+	iterator erase(const_iterator pos) {
+		iterator p = begin() + (pos - begin());
+		std::move(p + 1, end(), p);
+		pop_back();
+		return p;
+	}
+
+	void pop_back() {
+		std::destroy_at(data() + count - 1);
+		--count;
+	}
+
+	void clear() {
+		std::destroy(begin(), end());
+		count = 0;
+	}
+
+	T* data() { return std::launder(reinterpret_cast<T*>(storage)); }
+	const T* data() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+
+	reference operator[] (size_type i) { return data()[i]; }
+	const_reference operator[] (size_type i) const { return data()[i]; }
+
+	size_type size() const { return count; }
+	static constexpr size_type capacity() { return N; }
+	bool empty() const { return count == 0; }
+
+	iterator begin() { return data(); }
+	iterator end() { return data() + count; }
+	const_iterator begin() const { return data(); }
+	const_iterator end() const { return data() + count; }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+};
+
+template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class small_vector {
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+private:
+	alignas(T) std::byte storage[N * sizeof(T)];
+	T* buf{ inline_buffer() };
+	size_type count{ 0 };
+	size_type cap{ N };
+	Allocator alloc;
+
+	T* inline_buffer() { return reinterpret_cast<T*>(storage); }
+	bool on_heap() const { return cap > N; }
+
+	// moves the elements into new_buf and takes it over; if that throws, the caller still owns new_buf
+	// and the vector is unchanged: like std::vector, elements are copied unless their move cannot throw
+	void relocate(T* new_buf, size_type new_cap) {
+		if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+			std::uninitialized_move(buf, buf + count, new_buf);
+		else
+			std::uninitialized_copy(buf, buf + count, new_buf);
+		std::destroy(buf, buf + count);
+		if (on_heap())
+			alloc.deallocate(buf, cap);
+		buf = new_buf;
+		cap = new_cap;
+	}
+
+	void grow(size_type new_cap) {
+		T* new_buf = alloc.allocate(new_cap);
+		try {
+			relocate(new_buf, new_cap);
+		}
+		catch (...) {
+			alloc.deallocate(new_buf, new_cap);
+			throw;
+		}
+	}
+
+	// constructs the new last element before the old ones are moved, so args may refer to one of
+	// them, as in v.push_back(v[0]), like std::vector allows
+	template<typename... Args>
+	T* grow_emplace(Args&&... args) {
+		size_type new_cap = cap * 2;
+		T* new_buf = alloc.allocate(new_cap);
+		T* p = new_buf + count;
+		try {
+			std::construct_at(p, std::forward<Args>(args)...);
+		}
+		catch (...) {
+			alloc.deallocate(new_buf, new_cap);
+			throw;
+		}
+		try {
+			relocate(new_buf, new_cap);
+		}
+		catch (...) {
+			std::destroy_at(p);
+			alloc.deallocate(new_buf, new_cap);
+			throw;
+		}
+		return p;
+	}
+
+public:
+	small_vector() = default;
+
+	small_vector(std::initializer_list<T> init) {
+		reserve(init.size());
+		for (const auto& v : init)
+			push_back(v);
+	}
+
+	small_vector(const small_vector& other) {
+		reserve(other.size());
+		for (const auto& v : other)
+			push_back(v);
+	}
+
+	small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		if (other.on_heap()) {									// a heap buffer can simply change owner
+			buf = std::exchange(other.buf, other.inline_buffer());
+			cap = std::exchange(other.cap, N);
+			count = std::exchange(other.count, 0);
+		}
+		else {
+			for (auto& v : other)
+				push_back(std::move(v));
+			other.clear();
+		}
+	}
+
+	small_vector& operator= (small_vector other) {
+		clear();
+		if (other.on_heap()) {
+			if (on_heap())
+				alloc.deallocate(buf, cap);
+			buf = std::exchange(other.buf, other.inline_buffer());
+			cap = std::exchange(other.cap, N);
+			count = std::exchange(other.count, 0);
+		}
+		else {
+			for (auto& v : other)
+				push_back(std::move(v));
+		}
+		return *this;
+	}
+
+	~small_vector() {
+		clear();
+		if (on_heap())
+			alloc.deallocate(buf, cap);
+	}
+
+	void push_back(const T& value) { emplace_back(value); }
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+
+	template<typename... Args>
+	reference emplace_back(Args&&... args) {
+		T* p = (count == cap) ? grow_emplace(std::forward<Args>(args)...)
+			: std::construct_at(buf + count, std::forward<Args>(args)...);
+		++count;
+		return *p;
+	}
+
+	iterator insert(const_iterator pos, T value) {
+		auto i = pos - begin();
+		emplace_back(std::move(value));
+		std::rotate(begin() + i, end() - 1, end());
+		return begin() + i;
+	}
+
+	iterator erase(const_iterator pos) {
+		iterator p = begin() + (pos - begin());
+		std::move(p + 1, end(), p);
+		pop_back();
+		return p;
+	}
+
+	void pop_back() {
+		std::destroy_at(buf + count - 1);
+		--count;
+	}
+
+	void clear() {
+		std::destroy(begin(), end());
+		count = 0;
+	}
+
+	void reserve(size_type n) {
+		if (n > cap)
+			grow(std::max(n, cap * 2));
+	}
+
+	T* data() { return buf; }
+	const T* data() const { return buf; }
+
+	reference operator[] (size_type i) { return buf[i]; }
+	const_reference operator[] (size_type i) const { return buf[i]; }
+
+	size_type size() const { return count; }
+	size_type capacity() const { return cap; }
+	bool empty() const { return count == 0; }
+	bool is_inline() const { return !on_heap(); }
+
+	iterator begin() { return buf; }
+	iterator end() { return buf + count; }
+	const_iterator begin() const { return buf; }
+	const_iterator end() const { return buf + count; }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+};
+
+// std::allocator which counts how often it is asked for memory
+inline std::atomic<std::size_t> counted_allocations{ 0 };
+
+template<typename T>
+struct counting_allocator : std::allocator<T> {
+	using value_type = T;
+	counting_allocator() = default;
+	template<typename U>
+	counting_allocator(const counting_allocator<U>&) {}
+	template<typename U>
+	struct rebind { using other = counting_allocator<U>; };
+
+	T* allocate(std::size_t n) {
+		counted_allocations.fetch_add(1, std::memory_order_relaxed);
+		return std::allocator<T>::allocate(n);
+	}
+};
+
+void inline_containers_Example()
+{
+	// Arithmetical_library_operators() with a static_vector in place of int arr[]
+	static_vector<int, 2> arr{ 50, 30 };
+	std::cout << "\nstatic_vector<int, 2> arr{ 50,30 };\n"
+		"100-50-30 = " << std::accumulate(std::cbegin(arr), std::cend(arr), 100, std::minus<int>()) << "\n";
+
+	// Logical_operators(), the result is filled through a back_inserter instead of a bool[4]
+	static_vector<bool, 4> first{ true, false, true, false }, second{ true, true, false, false }, result;
+	std::transform(std::cbegin(first), std::cend(first), std::cbegin(second), std::back_inserter(result), std::logical_and<bool>());
+	for (std::size_t i = 0; i < result.size(); i++)
+		std::cout << first[i] << " AND " << second[i] << " = " << result[i] << "\n";
+
+	// the global vec, inline until it holds more than 8
+	small_vector<int, 8> small_vec{ 3,1,4,1,5,9 };
+	auto odd = std::find_if(std::cbegin(small_vec), std::cend(small_vec), is_odd());
+	std::cout << "\nfirst odd element of small_vec: " << *odd << "\n";
+
+	std::fill_n(std::inserter(small_vec, std::begin(small_vec) + 1), 2, 7);
+	std::cout << "after inserting two 7s at position 1 (still inline: " << std::boolalpha << small_vec.is_inline() << "): ";
+	for (auto v : small_vec)
+		std::cout << v << ", ";
+
+	std::fill_n(std::back_inserter(small_vec), 4, 2);
+	std::cout << "\nafter appending four 2s (still inline: " << small_vec.is_inline() << std::noboolalpha << "): ";
+	for (auto v : small_vec)
+		std::cout << v << ", ";
+	std::cout << std::endl;
+
+	try {
+		arr.push_back(20);
+	}
+	catch (const std::length_error& e) {
+		std::cout << "arr.push_back(20) on a full static_vector<int, 2>: " << e.what() << "\n";
+	}
+}
+
+// builds a tiny container, then runs the algorithms used in this file over it
+template<typename Container>
+long long tiny_container_workload(std::size_t iterations)
+{
+	long long total{ 0 };
+	for (std::size_t i = 0; i < iterations; ++i) {
+		const int n = 2 + static_cast<int>(i % 5);				// 2 to 6 elements, like arr[] and vec
+		Container c;
+		for (int k = 0; k < n; ++k)
+			c.push_back(static_cast<int>(i) + k);
+		Container doubled;
+		std::transform(std::cbegin(c), std::cend(c), std::back_inserter(doubled), [](int x) { return 2 * x; });
+		auto odd = std::find_if(std::cbegin(c), std::cend(c), is_odd());
+		total += std::accumulate(std::cbegin(doubled), std::cend(doubled), 0LL) + (odd != std::cend(c) ? *odd : 0);
+	}
+	return total;
+}
+
+void inline_containers_benchmark(std::size_t iterations = 10000000)
+{
+	std::cout << "\n" << iterations << " times: fill 2-6 ints, transform() into a second container, find_if(), accumulate()\n";
+
+	auto run = [iterations](const char* name, auto workload) {
+		counted_allocations = 0;
+		long long total{ 0 };
+		double t = elapsed_ms([&] { total = workload(iterations); });
+		std::cout << name << ": " << t << " ms, " << counted_allocations.load() << " allocations (checksum " << total << ")\n";
+	};
+
+	run("std::vector<int>", tiny_container_workload<std::vector<int, counting_allocator<int>>>);
+	run("small_vector<int, 8>", tiny_container_workload<small_vector<int, 8, counting_allocator<int>>>);
+	run("small_vector<int, 4>", tiny_container_workload<small_vector<int, 4, counting_allocator<int>>>);
+	run("static_vector<int, 8>", tiny_container_workload<static_vector<int, 8>>);
+}
+
+// 
+// PROFILING THE ROUTINES
+// 
+// profile_routine() runs any of the routines above (sorting, _if_Finder, equal_strings_test, Logical_operators...)
+// and records
+//		- wall time (std::chrono::steady_clock)
+//		- cycles, instructions, cache misses and branch mispredictions from the CPU's hardware counters
+// 
+// On Linux the counters come from perf_event_open(), in user mode, for the calling thread plus (inherit)
+// every thread it starts after the counters are opened. The counts of a child thread are added when it
+// exits, so routines which join their threads before returning (parallel scans and set operations,
+// external_sort's readers) are counted in full; threads started before the first profile_routine() are not
+// If that is not allowed (containers, perf_event_paranoid, Windows...) we fall back to the time stamp
+// counter (rdtsc) for cycles, and the other counters are reported as missing
+// 
+// The results can be written as CSV or JSON, so IPC (instructions per cycle) and cache behaviour
+// can be compared between changes
+//
+
+struct profile_result {
+	std::string routine;
+	int run{ 0 };
+	double wall_ms{ 0.0 };
+	std::optional<std::uint64_t> cycles;
+	std::optional<std::uint64_t> instructions;
+	std::optional<std::uint64_t> cache_misses;
+	std::optional<std::uint64_t> branch_misses;
+	std::string cycle_source;									// "perf", "rdtsc" or "none"
+
+	std::optional<double> ipc() const {
+		if (cycles && instructions && *cycles > 0)
+			return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+		return std::nullopt;
+	}
+};
+
+// the four hardware counters, each opened on its own so one unsupported event does not lose the others
+class hardware_counters {
+private:
+	static constexpr std::size_t count{ 4 };					// cycles, instructions, cache misses, branch misses
+	std::array<int, count> fds{ -1, -1, -1, -1 };
+
+public:
+	hardware_counters() {
+#ifdef __linux__
+		const std::array<std::uint64_t, count> events{ PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+		for (std::size_t i = 0; i < count; ++i) {
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = events[i];
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.inherit = 1;									// pid 0 alone would count only the calling thread
+			fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+		}
+#endif
+	}
+
+	hardware_counters(const hardware_counters&) = delete;
+	hardware_counters& operator= (const hardware_counters&) = delete;
+
+	~hardware_counters() {
+#ifdef __linux__
+		for (int fd : fds)
+			if (fd >= 0)
+				::close(fd);
+#endif
+	}
+
+	bool available(std::size_t i) const { return fds[i] >= 0; }
+
+	void start() {
+#ifdef __linux__
+		for (int fd : fds)
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+	}
+
+	// stops counting and returns the values, missing ones are empty
+	std::array<std::optional<std::uint64_t>, count> stop() {
+		std::array<std::optional<std::uint64_t>, count> values;
+#ifdef __linux__
+		for (std::size_t i = 0; i < count; ++i) {
+			if (fds[i] < 0)
+				continue;
+			ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+			std::uint64_t v{ 0 };
+			if (::read(fds[i], &v, sizeof(v)) == static_cast<ssize_t>(sizeof(v)))
+				values[i] = v;
+		}
+#endif
+		return values;
+	}
+};
+
+inline std::optional<std::uint64_t> read_tsc()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::nullopt;
+#endif
+}
+
+// runs func once and measures it; with silence set, anything it prints to std::cout is thrown away
+// so the numbers are about the algorithm and not the console
+template<typename Func>
+profile_result profile_routine(const std::string& routine, Func&& func, int run = 0, bool silence = true)
+{
+	static hardware_counters counters;							// opened once, reused for every run
+
+	std::ostringstream sink;
+	std::wostringstream wsink;									// sorting() and friends also write to std::wcout
+	std::streambuf* saved = silence ? std::cout.rdbuf(sink.rdbuf()) : nullptr;
+	std::wstreambuf* wsaved = silence ? std::wcout.rdbuf(wsink.rdbuf()) : nullptr;
+
+	profile_result res;
+	res.routine = routine;
+	res.run = run;
+
+	auto tsc_start = read_tsc();
+	counters.start();
+	auto start = std::chrono::steady_clock::now();
+	func();
+	auto stop = std::chrono::steady_clock::now();
+	auto values = counters.stop();
+	auto tsc_stop = read_tsc();
+
+	if (saved)
+		std::cout.rdbuf(saved);
+	if (wsaved)
+		std::wcout.rdbuf(wsaved);
+
+	res.wall_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+	res.instructions = values[1];
+	res.cache_misses = values[2];
+	res.branch_misses = values[3];
+	if (values[0]) {
+		res.cycles = values[0];
+		res.cycle_source = "perf";
+	}
+	else if (tsc_start && tsc_stop) {
+		res.cycles = *tsc_stop - *tsc_start;
+		res.cycle_source = "rdtsc";
+	}
+	else {
+		res.cycle_source = "none";
+	}
+	return res;
+}
+
+template<typename Value>
+void write_optional(std::ostream& out, const std::optional<Value>& v, const char* missing)
+{
+	if (v)
+		out << *v;
+	else
+		out << missing;
+}
+
+void write_profile_csv(std::ostream& out, const std::vector<profile_result>& results)
+{
+	out << "routine,run,wall_ms,cycles,instructions,ipc,cache_misses,branch_misses,cycle_source\n";
+	for (const auto& r : results) {
+		out << r.routine << ',' << r.run << ',' << r.wall_ms << ',';
+		write_optional(out, r.cycles, "");
+		out << ',';
+		write_optional(out, r.instructions, "");
+		out << ',';
+		write_optional(out, r.ipc(), "");
+		out << ',';
+		write_optional(out, r.cache_misses, "");
+		out << ',';
+		write_optional(out, r.branch_misses, "");
+		out << ',' << r.cycle_source << '\n';
+	}
+}
+
+void write_profile_json(std::ostream& out, const std::vector<profile_result>& results)
+{
+	out << "[\n";
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const auto& r = results[i];
+		out << "  {\"routine\": \"" << r.routine << "\", \"run\": " << r.run << ", \"wall_ms\": " << r.wall_ms << ", \"cycles\": ";
+		write_optional(out, r.cycles, "null");
+		out << ", \"instructions\": ";
+		write_optional(out, r.instructions, "null");
+		out << ", \"ipc\": ";
+		write_optional(out, r.ipc(), "null");
+		out << ", \"cache_misses\": ";
+		write_optional(out, r.cache_misses, "null");
+		out << ", \"branch_misses\": ";
+		write_optional(out, r.branch_misses, "null");
+		out << ", \"cycle_source\": \"" << r.cycle_source << "\"}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "]\n";
+}
+
+void profile_routines_Example(int runs = 5)
+{
+	const std::vector<std::pair<std::string, std::function<void()>>> routines{
+		{ "findstring", findstring },
+		{ "sorting", sorting },
+		{ "sorting_with_object", sorting_with_object },
+		{ "_if_Finder", _if_Finder },
+		{ "is_ODD_Lambda", is_ODD_Lambda },
+		{ "equal_strings", [] { equal_strings_test("lambda", "Lambda"); } },
+		{ "Capture_example", Capture_example },
+		{ "less_library_implementation", less_library_implementation },
+		{ "Logical_operators", Logical_operators },
+	};
+
+	std::vector<profile_result> results;
+	for (const auto& [name, routine] : routines)
+		for (int run = 0; run < runs; ++run)
+			results.push_back(profile_routine(name, routine, run));
+
+	std::ofstream csv("profile.csv"), json("profile.json");
+	write_profile_csv(csv, results);
+	write_profile_json(json, results);
+
+	std::cout << "\nwrote " << results.size() << " runs to profile.csv and profile.json\n\n";
+	write_profile_csv(std::cout, results);
+}
+
+// 
+// COUNTING AND TIMING PREDICATE CALLS
+// 
+// How many times does std::sort() call is_shorter? How many elements does find_if() hand to ge_n
+// before it finds one? And is the time going into the comparisons or into moving the elements?
+// 
+// counted(f, "site") and timed(f, "site") wrap any comparator or predicate and behave exactly like it
+//		- counted() adds one relaxed atomic increment per call
+//		- timed() also reads the clock around every call and files the latency into a log2 histogram,
+//		  the cost of reading the clock is measured once and subtracted
+// 
+// Algorithms copy their predicates freely, so the numbers are not kept in the wrapper but in a
+// call_site_stats object looked up by name: every copy, and every thread, adds to the same totals
+// 
+// call_sites().report() prints calls, calls per element, mean latency, approximate percentiles and
+// the share of the algorithm's time spent inside the predicate
+//
+
+// what one pair of steady_clock::now() calls costs, subtracted from every timed call
+inline std::uint64_t clock_overhead_ns()
+{
+	static const std::uint64_t overhead = [] {
+		std::uint64_t best = std::numeric_limits<std::uint64_t>::max();
+		for (int i = 0; i < 1000; ++i) {
+			auto a = std::chrono::steady_clock::now();
+			auto b = std::chrono::steady_clock::now();
+			best = std::min<std::uint64_t>(best, std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+		}
+		return best;
+	}();
+	return overhead;
+}
+
+struct call_site_stats {
+	static constexpr std::size_t buckets{ 32 };				// bucket b holds calls taking [2^b, 2^(b+1)) ns, bucket 0 also holds 0
+
+	std::string name;
+	std::atomic<std::uint64_t> calls{ 0 };
+	std::atomic<std::uint64_t> total_ns{ 0 };
+	std::atomic<std::uint64_t> elements{ 0 };					// set by the caller, for calls per element
+	std::atomic<std::uint64_t> algorithm_ns{ 0 };				// set by the caller, for the share spent in the predicate
+	std::array<std::atomic<std::uint64_t>, buckets> histogram{};
+
+	explicit call_site_stats(std::string name) : name(std::move(name)) {}
+
+	void reset() {
+		calls = 0;
+		total_ns = 0;
+		elements = 0;
+		algorithm_ns = 0;
+		for (auto& h : histogram)
+			h = 0;
+	}
+
+	void record(std::uint64_t ns) {
+		calls.fetch_add(1, std::memory_order_relaxed);
+		total_ns.fetch_add(ns, std::memory_order_relaxed);
+		std::size_t b = ns == 0 ? 0 : std::min<std::size_t>(std::bit_width(ns) - 1, buckets - 1);
+		histogram[b].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// upper bound of the bucket which holds the given fraction of calls
+	std::uint64_t percentile_ns(double fraction) const {
+		std::uint64_t timed_calls{ 0 };
+		for (const auto& h : histogram)
+			timed_calls += h.load();
+		std::uint64_t seen{ 0 };
+		for (std::size_t b = 0; b < buckets; ++b) {
+			seen += histogram[b].load();
+			if (timed_calls > 0 && seen >= fraction * timed_calls)
+				return std::uint64_t{ 2 } << b;
+		}
+		return 0;
+	}
+};
+
+class call_site_registry {
+private:
+	std::mutex registry_mutex;
+	std::map<std::string, std::unique_ptr<call_site_stats>> sites;
+
+public:
+	call_site_stats& site(const std::string& name) {
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		auto& entry = sites[name];
+		if (!entry)
+			entry = std::make_unique<call_site_stats>(name);
+		return *entry;
+	}
+
+	// zeroes every site in place: live counted/timed wrappers keep pointers to them, so they are never destroyed
+	void reset() {
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		for (auto& [name, s] : sites)
+			s->reset();
+	}
+
+	void report(std::ostream& out) {
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		out << "\ncall site                              calls   per elem   mean ns   ~p50 ns   ~p99 ns   in predicate\n";
+		for (const auto& [name, s] : sites) {
+			auto calls = s->calls.load();
+			auto elements = s->elements.load();
+			if (calls == 0 && elements == 0)
+				continue;											// nothing since the last reset()
+			auto timed_calls = std::accumulate(std::cbegin(s->histogram), std::cend(s->histogram), std::uint64_t{ 0 },
+				[](std::uint64_t sum, const std::atomic<std::uint64_t>& h) {return sum + h.load(); });
+
+			out << std::left << std::setw(34) << name << std::right << std::setw(11) << calls;
+			out << std::setw(11);
+			if (elements) out << std::fixed << std::setprecision(2) << static_cast<double>(calls) / elements; else out << "-";
+			out << std::setw(10);
+			if (timed_calls) out << std::fixed << std::setprecision(1) << static_cast<double>(s->total_ns.load()) / timed_calls; else out << "-";
+			out << std::setw(10);
+			if (timed_calls) out << s->percentile_ns(0.5); else out << "-";
+			out << std::setw(10);
+			if (timed_calls) out << s->percentile_ns(0.99); else out << "-";
+			// the algorithm's own time also paid for the clock reads, take those out too
+			auto clock_ns = timed_calls * clock_overhead_ns();
+			auto algorithm_ns = s->algorithm_ns.load() > clock_ns ? s->algorithm_ns.load() - clock_ns : 0;
+			out << std::setw(14);
+			if (timed_calls && algorithm_ns)
+				out << std::fixed << std::setprecision(1) << 100.0 * s->total_ns.load() / algorithm_ns << " %";
+			else
+				out << "-";
+			out << "\n";
+		}
+		out << std::defaultfloat << std::setprecision(6);
+	}
+};
+
+inline call_site_registry& call_sites()
+{
+	static call_site_registry registry;
+	return registry;
+}
+
+template<typename Func>
+class counted {
+private:
+	mutable Func func;											// so the const operator() can also call functors whose operator() is not const
+	call_site_stats* stats;
+public:
+	counted(Func func, const std::string& site) : func(std::move(func)), stats(&call_sites().site(site)) {}
+
+	template<typename... Args>
+	decltype(auto) operator() (Args&&... args) const {
+		stats->calls.fetch_add(1, std::memory_order_relaxed);
+		return func(std::forward<Args>(args)...);
+	}
+};
+
+template<typename Func>
+class timed {
+private:
+	mutable Func func;
+	call_site_stats* stats;
+	std::uint64_t overhead;
+public:
+	timed(Func func, const std::string& site) : func(std::move(func)), stats(&call_sites().site(site)), overhead(clock_overhead_ns()) {}
+
+	template<typename... Args>
+	decltype(auto) operator() (Args&&... args) const {
+		auto start = std::chrono::steady_clock::now();
+		decltype(auto) res = func(std::forward<Args>(args)...);
+		auto stop = std::chrono::steady_clock::now();
+		std::uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+		stats->record(ns > overhead ? ns - overhead : 0);
+		return res;
+	}
+};
+
+// runs the algorithm call and records the element count and its total time against the site
+template<typename Func>
+void measure_site(const std::string& site, std::size_t elements, Func&& algorithm_call)
+{
+	auto& s = call_sites().site(site);
+	double ms = elapsed_ms(std::forward<Func>(algorithm_call));
+	s.elements += elements;
+	s.algorithm_ns += static_cast<std::uint64_t>(ms * 1e6);
+}
+
+void instrumented_predicates_Example(std::size_t n = 1000000)
+{
+	call_sites().reset();
+
+	std::mt19937 rng(11);
+	std::vector<std::string> names(n);
+	for (auto& name : names)
+		name = std::string(1 + rng() % 12, static_cast<char>('a' + rng() % 26));
+
+	// std::sort: how many comparisons, and how much of the sort is the comparator?
+	auto a = names, b = names, c = names;
+	measure_site("sort / is_shorter (counted)", n, [&] { std::sort(std::begin(a), std::end(a), counted(is_shorter, "sort / is_shorter (counted)")); });
+	measure_site("sort / is_shorter (timed)", n, [&] { std::sort(std::begin(b), std::end(b), timed(is_shorter, "sort / is_shorter (timed)")); });
+	measure_site("sort / is_shorter_2 (timed)", n, [&] { std::sort(std::begin(c), std::end(c), timed(is_shorter_2(), "sort / is_shorter_2 (timed)")); });
+
+	// find_if scans: how far does each one get?
+	std::ptrdiff_t found_gt_5{ -1 }, found_ge_11{ -1 };
+	measure_site("find_if / greater_than_5", n, [&] {
+		auto it = std::find_if(std::cbegin(names), std::cend(names), timed(greater_than_5(), "find_if / greater_than_5"));
+		found_gt_5 = it != std::cend(names) ? it - std::cbegin(names) : -1;
+	});
+	measure_site("find_if / ge_n(11)", n, [&] {
+		auto it = std::find_if(std::cbegin(names), std::cend(names), timed(ge_n(11), "find_if / ge_n(11)"));
+		found_ge_11 = it != std::cend(names) ? it - std::cbegin(names) : -1;
+	});
+
+	// the lambda from equal_strings(), over every adjacent pair
+	// the 4 iterator std::equal() returns at once when the lengths differ, so "per elem" here is lambda calls per pair
+	std::size_t equal_pairs{ 0 };
+	auto char_equal = timed([](char lc, char rc) {return toupper(static_cast<unsigned char>(lc)) == toupper(static_cast<unsigned char>(rc)); },
+		"equal / equal_strings lambda");
+	measure_site("equal / equal_strings lambda", n - 1, [&] {
+		for (std::size_t i = 1; i < n; ++i)
+			equal_pairs += std::equal(std::cbegin(names[i - 1]), std::cend(names[i - 1]), std::cbegin(names[i]), std::cend(names[i]), char_equal);
+	});
+
+	std::cout << "\n" << n << " random names, clock overhead " << clock_overhead_ns() << " ns per timed call (subtracted)";
+	std::cout << "\nfirst name longer than 5 at " << found_gt_5 << ", longer than 11 at " << found_ge_11
+		<< ", " << equal_pairs << " adjacent pairs equal ignoring case";
+	call_sites().report(std::cout);
+}
+
 int main()
 {
 	//findstring();
+	//find_substrings_Example();
+	//substring_search_benchmark();
 	//sorting();
 	//sorting_with_object();
+	//sorted_names_Example();
+	//sorted_names_benchmark();
+	//top_k_Example();
+	//top_k_benchmark();
+	//set_operations_Example();
+	//set_operations_benchmark();
 	//-------------------------------------------------------//
 	//_if_Finder();
+	//fixed_length_predicate_benchmark();
 	//-------------------------------------------------------//
 	//is_ODD();
 	//is_ODD_Lambda();
+	//is_ODD_Snapshot();
+	//snapshot_vector_benchmark();
 
 	//-------------------------------------------------------//
 	//equal_strings_test("lambda", "Lambda");
 	//equal_strings_test("lambda", "Lambdada");
+	//case_insensitive_sort_Example();
+	//case_insensitive_sort_benchmark();
 	//-------------------------------------------------------//
 
 																	// int main(){} == scope containing lambda expression
@@ -1104,6 +5874,9 @@ int main()
 
 	//-----------------------------------------------------------//
 	//Storing_Lambdas();
+	//predicate_copy_cost_benchmark();
+	//mapped_corpus_Example("names.txt");
+	//corpus_load_benchmark();
 	//-----------------------------------------------------------//
 
 	//-----------------------------------------------------------//
@@ -1121,19 +5894,36 @@ int main()
 	// Pair Types:
 	
 	//Pairs_example();
+	//compact_pair_table_benchmark();
 
 	//----------------------------------------------------------//
 	//back_insert_iterator_Example();
+	//back_inserter_benchmark();
+	//concurrent_append_benchmark();
 	//front_insert_iterator_Example();
+	//ring_deque_Example();
+	//ring_deque_benchmark();
 	
 //	insert_iterator_Example();
+	//batched_insert_benchmark();
 	
 
 	//----------------------------------------------------------//
 
 	//less_library_implementation();
+	//constexpr_tables_Example();
+	//constexpr_tables_benchmark();
+	//external_sort_benchmark();
+	//Arithmetical_library_operators();
+	//string_offsets_Example();
+	//parallel_scan_benchmark();
 
 	Logical_operators();
+	//inline_containers_Example();
+	//inline_containers_benchmark();
+
+	//profile_routines_Example();
+	//instrumented_predicates_Example();
 	
 	std::cin.get();
 